@@ -0,0 +1,79 @@
+/**
+  ******************************************************************************
+  * @file    combo.h
+  * @brief   组合键 (combo / chord) 识别引擎头文件
+  * @note    在组合窗口内同时按下的按键集合触发独立的动作，位于按键事件流水线中 tapHold 之前
+  ******************************************************************************
+  */
+
+#ifndef __COMBO_H__
+#define __COMBO_H__
+
+#include <Arduino.h>
+#include "key.h"
+#include "tapHold.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =================================================================================
+// 宏定义与结构体
+// =================================================================================
+
+#define CMB_KEY_COUNT 5                    // 物理按键数
+#define CMB_MASK_COUNT (1 << CMB_KEY_COUNT) // 按键集合数 (查找表大小)
+#define CMB_MAX_COMBOS 8                   // 最多组合数
+#define CMB_WINDOW_MS 50                   // 默认组合窗口 (单位: ms)
+#define CMB_SOURCE TH_KEY_COUNT            // 组合动作使用的报文来源索引 (物理按键之后)
+
+/** * @brief 组合定义
+ */
+typedef struct {
+    uint8_t mask;     // 按键集合，bit i 对应 Key i+1 (至少两个键)
+    KeyAction action; // 触发的动作
+} CMB_Combo;
+
+/** * @brief 引擎统计
+ */
+typedef struct {
+    uint32_t fired;    // 触发的组合数
+    uint32_t flushed;  // 缓存后未组成组合、按原样转发的按下次数
+    uint32_t timeouts; // 因窗口到期而结束等待的次数
+} CMB_Stats;
+
+// =================================================================================
+// 函数原型
+// =================================================================================
+
+/**
+  * @brief  初始化引擎
+  * @param  next 下游事件处理 (通常为 TH_Process)
+  * @param  sink 组合动作输出回调 (key 参数为 CMB_SOURCE)
+  */
+void CMB_Init(void (*next)(const KeyEvent *evt), TH_ActionSink sink);
+
+/**
+  * @brief  设置组合表并预编译查找表
+  * @param  combos   组合数组 (内容会被复制)
+  * @param  count    组合数，超出 CMB_MAX_COMBOS 的部分忽略
+  * @param  windowMs 组合窗口，0 表示使用 CMB_WINDOW_MS
+  */
+void CMB_SetCombos(const CMB_Combo *combos, uint8_t count, uint16_t windowMs);
+
+/**
+  * @brief  处理一个按键事件 (KEY_SetEventCallback 回调，主循环上下文)
+  * @param  evt 按键事件，非组合相关的事件直接转发给下游
+  */
+void CMB_Process(const KeyEvent *evt);
+
+/**
+  * @brief  获取引擎统计
+  */
+void CMB_GetStats(CMB_Stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,113 @@
+/**
+  ******************************************************************************
+  * @file    hidReport.h
+  * @brief   HID 键盘报文合成器头文件
+  * @note    将所有按住按键的修饰键与键码合并为一个 6KRO 报文，必要时切换为 NKRO 位图报文
+  ******************************************************************************
+  */
+
+#ifndef __HID_REPORT_H__
+#define __HID_REPORT_H__
+
+#include <Arduino.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =================================================================================
+// 宏定义与结构体
+// =================================================================================
+
+#define HID_REPORT_LEN 8      // 标准键盘报文长度
+#define HID_MAX_KEYS 6        // 6KRO 键码槽位数
+#define HID_MAX_SOURCES 8     // 可同时按住的报文来源数 (物理按键等)
+
+#define HID_ERR_ROLLOVER 0x01 // 键码超过 6 个时填充的 ErrorRollOver
+#define HID_BOOT_MAX_USAGE 0x65 // 6KRO 报文描述符可表示的最大键码
+
+#define HID_NKRO_LEN 29       // NKRO 位图长度：用法 0x00 ~ 0xE7 共 232 位
+#define HID_NKRO_MOD_BYTE 28  // 修饰键 (0xE0 ~ 0xE7) 在位图中所在字节
+
+// HID_Compose 返回值：需要发送的报文
+#define HID_SEND_BOOT 0x01    // 6KRO 报文有变化
+#define HID_SEND_NKRO 0x02    // NKRO 位图有变化
+
+/** * @brief 报文模式
+ */
+typedef enum {
+    HID_MODE_6KRO = 0, // 兼容 Boot 协议的 6 键报文
+    HID_MODE_NKRO      // 位图报文 (全键无冲)
+} HID_ReportMode;
+
+/** * @brief 合成结果
+ * @note  模式为 NKRO 时 boot 为全 0，反之 nkro 为全 0；
+ *        发送时先发当前模式的报文，再发另一个 (清空旧报文)，切换过程中不会出现短暂的释放
+ */
+typedef struct {
+    uint8_t mode;                    // HID_ReportMode
+    uint8_t boot[HID_REPORT_LEN];    // 6KRO 报文
+    uint8_t nkro[HID_NKRO_LEN];      // NKRO 位图
+} HID_Output;
+
+/** * @brief 合成器统计
+ */
+typedef struct {
+    uint32_t composed;   // 合成次数 (每次按下/释放)
+    uint32_t sent;       // 与上次不同、需要发送的报文数
+    uint32_t suppressed; // 与上次相同而被抑制的报文数
+    uint32_t rollover;   // 键码溢出 (ErrorRollOver) 次数
+    uint32_t nkroSwitch; // 切换到 NKRO 的次数
+} HID_Stats;
+
+// =================================================================================
+// 函数原型
+// =================================================================================
+
+/**
+  * @brief  来源按下：登记其 8 字节报文 (修饰键 + 键码)
+  * @param  src    来源索引 (0 ~ HID_MAX_SOURCES-1)，物理按键使用 0-4
+  * @param  report 8 字节报文，格式同预设键位
+  */
+void HID_KeyDown(uint8_t src, const uint8_t *report);
+
+/**
+  * @brief  来源释放
+  * @param  src 来源索引
+  */
+void HID_KeyUp(uint8_t src);
+
+/**
+  * @brief  清空所有按住的来源 (上次发送的报文保持不变)
+  */
+void HID_Reset();
+
+/**
+  * @brief  合成当前报文
+  * @note   按住超过 6 个普通键码，或出现 6KRO 描述符无法表示的键码 (> 0x65，如 F13-F24、国际键) 时
+  *         切换到 NKRO，直到全部按键释放后再回到 6KRO
+  * @param  out 输出合成结果
+  * @retval 需要发送的报文 (HID_SEND_BOOT / HID_SEND_NKRO 的组合)，0 表示无变化
+  */
+uint8_t HID_Compose(HID_Output *out);
+
+/**
+  * @brief  启用/禁用 NKRO (禁用时超出部分按 ErrorRollOver 处理)
+  */
+void HID_SetNkroEnabled(bool enabled);
+
+/**
+  * @brief  强制下一次 HID_Compose 视为两个报文均有变化 (例如重新连接后需要同步主机状态)
+  */
+void HID_Invalidate();
+
+/**
+  * @brief  获取合成器统计
+  */
+void HID_GetStats(HID_Stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -6,16 +6,34 @@ This IIC library is transplanted from my STC89C52RC microcontroller library.
 #ifndef __IIC_H__
 #define __IIC_H__
 
+#ifndef IIC_HAL_MOCK
 #include <Arduino.h>
 #include <def.h>
+#endif
+#include "iic_hal.h"
+
+// 总线后端：软件模拟为默认与兜底方案
+typedef enum {
+	IIC_BACKEND_SOFT = 0, // GPIO 翻转模拟时序
+	IIC_BACKEND_HW        // ESP32-C3 硬件 I2C 控制器 (命令队列 + FIFO)
+} IIC_Backend;
+
+#define IIC_HW_PORT       0  // ESP32-C3 仅有一个 I2C 控制器
+#define IIC_HW_TIMEOUT_MS 20 // 单次硬件传输超时
 
 typedef struct {
+	uint8_t Backend;
 	uint8_t SCL_Pin;
 	uint8_t SDA_Pin;
 	uint8_t Delay;
+	uint32_t SCL_Mask; // SCL 在 GPIO 寄存器中的位掩码 (IIC_Init 中计算)
+	uint32_t SDA_Mask; // SDA 在 GPIO 寄存器中的位掩码
 } IIC_BusCfg;
 
 void IIC_Init(uint8_t SCL, uint8_t SDA, uint8_t spd, uint8_t bus);
+uint8_t IIC_InitHW(uint8_t SCL, uint8_t SDA, uint32_t freq, uint8_t bus);
+
+// 以下逐字节时序接口仅适用于软件后端
 void IIC_Start(uint8_t bus);
 void IIC_Stop(uint8_t bus);
 void IIC_SendByte(uint8_t bus, uint8_t byte);
@@ -23,4 +41,7 @@ uint8_t IIC_ReadByte(uint8_t bus);
 uint8_t IIC_RcvACK(uint8_t bus);
 void IIC_SendACK(uint8_t bus, uint8_t ack);
 
+// 传输接口：根据总线后端自动分派
+bool IIC_WriteBurst(uint8_t bus, uint8_t addr, uint8_t ctrl, const uint8_t* data, uint16_t len);
+
 #endif
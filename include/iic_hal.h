@@ -0,0 +1,103 @@
+/*
+IIC GPIO hardware abstraction.
+Bit edges are issued as single stores to the ESP32-C3 GPIO set/clear registers.
+Build with IIC_HAL_MOCK defined to run the same IIC code on a host against a
+mock register file; pin setup and delays then go through the mock as well, so
+the IIC code does not need Arduino.h.
+*/
+
+#ifndef __IIC_HAL_H__
+#define __IIC_HAL_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef IIC_HAL_MOCK
+
+#define LOW    0x0
+#define HIGH   0x1
+#define OUTPUT 0x03
+
+#define IIC_MOCK_TRACE_LEN 1024
+
+// 模拟寄存器组：out 为输出锁存，in 为引脚输入 (由测试代码注入)
+typedef struct {
+	uint32_t out;
+	uint32_t in;
+	uint32_t edges;                      // 所有引脚累计电平跳变次数
+	uint32_t trace[IIC_MOCK_TRACE_LEN];  // 每次电平变化后的 out，用于还原时序
+	uint16_t traceLen;
+	uint8_t pinMode[32];                 // 各引脚最后设置的模式
+	uint32_t delayUs;                    // 累计延时
+} IIC_MockRegs;
+
+extern IIC_MockRegs IIC_Mock;
+
+static inline void IIC_HAL_Trace(void) {
+	if (IIC_Mock.traceLen < IIC_MOCK_TRACE_LEN) {
+		IIC_Mock.trace[IIC_Mock.traceLen++] = IIC_Mock.out;
+	}
+}
+
+static inline void IIC_HAL_Set(uint32_t mask) {
+	uint32_t rise = ~IIC_Mock.out & mask;
+
+	IIC_Mock.edges += __builtin_popcount(rise);
+	IIC_Mock.out |= mask;
+	if (rise) {
+		IIC_HAL_Trace();
+	}
+}
+
+static inline void IIC_HAL_Clr(uint32_t mask) {
+	uint32_t fall = IIC_Mock.out & mask;
+
+	IIC_Mock.edges += __builtin_popcount(fall);
+	IIC_Mock.out &= ~mask;
+	if (fall) {
+		IIC_HAL_Trace();
+	}
+}
+
+static inline uint32_t IIC_HAL_Read(void) {
+	return IIC_Mock.in;
+}
+
+static inline void IIC_HAL_PinMode(uint8_t pin, uint8_t mode) {
+	IIC_Mock.pinMode[pin & 31] = mode;
+}
+
+static inline void IIC_HAL_Delay(uint32_t us) {
+	IIC_Mock.delayUs += us;
+}
+
+#else
+
+#include <Arduino.h>
+#include "soc/soc.h"
+#include "soc/gpio_reg.h"
+
+// ESP32-C3 只有 22 个 GPIO，全部位于同一组 32 位寄存器中
+static inline void IIC_HAL_Set(uint32_t mask) {
+	REG_WRITE(GPIO_OUT_W1TS_REG, mask);
+}
+
+static inline void IIC_HAL_Clr(uint32_t mask) {
+	REG_WRITE(GPIO_OUT_W1TC_REG, mask);
+}
+
+static inline uint32_t IIC_HAL_Read(void) {
+	return REG_READ(GPIO_IN_REG);
+}
+
+static inline void IIC_HAL_PinMode(uint8_t pin, uint8_t mode) {
+	pinMode(pin, mode);
+}
+
+static inline void IIC_HAL_Delay(uint32_t us) {
+	delayMicroseconds(us);
+}
+
+#endif
+
+#endif
@@ -20,17 +20,51 @@ extern "C" {
 // 宏定义与结构体
 // =================================================================================
 
-// 长按判定阈值 (单位: ms)
+// 长按判定阈值 (单位: ms)，即 KEY_EVT_HOLD 的默认保持时间
 #define LONG_PRESS_TIME 1500 
 
+// 默认去抖窗口 (单位: ms)，可通过 KEY_SetDebounce() 修改
+#define KEY_DEBOUNCE_MS 5
+
+// 按键扫描周期 (单位: us)，即 KEY_Detect 定时器的中断周期
+#define KEY_SCAN_PERIOD_US 1000
+
+/** * @brief 按键输入模式
+ */
+typedef enum {
+    KEY_INPUT_SCAN = 0, // 仅定时扫描：连续采样一致后才上报
+    KEY_INPUT_IRQ       // 边沿中断：首个边沿立即上报，之后由扫描校验 (默认)
+} KEY_InputMode;
+
 /** * @brief 按键状态结构体 
  */
 typedef struct {
-    bool isPressed;   // 当前物理状态：是否被按下
-    bool shouldSend;  // 逻辑标志：是否应该发送 HID 报文
-    bool isReleased;  // 逻辑标志：是否刚刚被释放 (用于触发 Release 报文)
+    bool isPressed;   // 去抖后的状态：是否被按下
+    bool pressEdge;   // 边沿：本次 KEY_Update 中由释放变为按下 (KEY_GetPressedMask 的对应位)
+    bool releaseEdge; // 边沿：本次 KEY_Update 中由按下变为释放 (KEY_GetReleasedMask 的对应位)
 } KeyState;
 
+// 事件队列长度 (必须为 2 的幂)
+#define KEY_EVENT_QUEUE_LEN 32
+
+/** * @brief 按键事件类型
+ */
+typedef enum {
+    KEY_EVT_PRESS = 0,  // 按下
+    KEY_EVT_RELEASE,    // 释放
+    KEY_EVT_HOLD,       // 保持 (按下持续该键的保持时间，每次按下最多一次，见 KEY_SetHoldTime)
+    KEY_EVT_TICK,       // 秒计时 (定时器模式)
+    KEY_EVT_TIMEOUT     // KEY_SetDeadline 设置的时间到期
+} KeyEventType;
+
+/** * @brief 按键事件 (由中断写入事件队列)
+ */
+typedef struct {
+    uint32_t time;    // 时间戳 (esp_timer_get_time() 低 32 位, us)
+    uint8_t type;     // KeyEventType
+    uint8_t key;      // 按键索引 (0-4)
+} KeyEvent;
+
 // =================================================================================
 // 全局变量声明
 // =================================================================================
@@ -38,22 +72,6 @@ typedef struct {
 // 全局按键使能标志 (true = 允许发送键值)
 extern bool enableKey;
 
-// --- 长按检测相关 (数组化) ---
-// 索引 0-4 对应 Key1-Key5
-extern bool keyLongPressed[5];       // 长按触发标志位
-extern uint32_t keyPressStartTime[5]; // 按下起始时间戳
-
-// 全局释放请求标志
-extern bool sendRelease;
-
-// --- HID 报文缓冲区 ---
-// 对应 Key1 - Key5 的发送数据
-extern char k1Buf[8];
-extern char k2Buf[8];
-extern char k3Buf[8];
-extern char k4Buf[8];
-extern char k5Buf[8];
-
 // 通用释放报文 (全0)
 extern char release[8];
 
@@ -70,11 +88,113 @@ extern KeyState keyState[5];
 void KEY_Init();
 
 /**
-  * @brief  更新按键状态 (去抖 + 长按检测)
+  * @brief  按键扫描与去抖 (由 KEY_SCAN_PERIOD_US 周期的定时器中断调用)
+  */
+void KEY_Scan();
+
+/**
+  * @brief  更新按键状态 (消费事件队列)，不阻塞
   * @retval bool 是否有任意按键处于活动状态
   */
 bool KEY_Update();
 
+/**
+  * @brief  投递一个秒计时 (TICK) 事件 (中断上下文)
+  */
+void KEY_PostTick();
+
+/**
+  * @brief  从事件队列取出一个事件
+  * @param  evt 输出事件
+  * @retval bool 是否取到事件
+  */
+bool KEY_PopEvent(KeyEvent *evt);
+
+/**
+  * @brief  获取事件队列统计 (参数均可为 NULL)
+  * @param  depth    当前队列深度
+  * @param  maxDepth 历史最大深度
+  * @param  overflow 溢出丢弃的事件数
+  */
+void KEY_GetEventStats(uint8_t *depth, uint8_t *maxDepth, uint32_t *overflow);
+
+/**
+  * @brief  注册 TICK 事件回调 (在主循环上下文中执行)
+  */
+void KEY_SetTickCallback(void (*cb)(void));
+
+/**
+  * @brief  注册按键事件回调 (按下/释放/保持/超时，在主循环上下文中执行)
+  * @note   回调在 keyState 更新之后调用，事件时间戳来自中断
+  */
+void KEY_SetEventCallback(void (*cb)(const KeyEvent *evt));
+
+/**
+  * @brief  设置按键的保持时间
+  * @param  i  按键索引 (0-4)
+  * @param  ms 按下持续该时间后上报 KEY_EVT_HOLD，0 表示不上报
+  */
+void KEY_SetHoldTime(uint8_t i, uint16_t ms);
+
+/**
+  * @brief  设置一次性到期时间，到期后由扫描中断上报 KEY_EVT_TIMEOUT
+  * @param  time 到期时间，与事件时间戳同一时基 (按扫描周期取整)
+  */
+void KEY_SetDeadline(uint32_t time);
+
+/**
+  * @brief  取消 KEY_SetDeadline 设置的到期时间 (已入队的超时事件不会撤回)
+  */
+void KEY_CancelDeadline();
+
+/**
+  * @brief  切换按键输入模式 (挂载/卸载 GPIO 边沿中断)
+  * @param  mode KEY_INPUT_SCAN 或 KEY_INPUT_IRQ
+  */
+void KEY_SetInputMode(KEY_InputMode mode);
+
+/**
+  * @brief  获取按键最近一次状态翻转的时间戳
+  * @param  i 按键索引 (0-4)
+  * @retval esp_timer_get_time() 时间 (us)
+  */
+int64_t KEY_GetEdgeTime(uint8_t i);
+
+/**
+  * @brief  清除本次 KEY_Update 的边沿 (keyState 边沿与下列边沿集合)
+  */
+void KEY_ClearEdges();
+
+// 以下集合均为位掩码，bit i 对应 Key i+1。边沿集合由扫描/边沿中断按
+// changed = state ^ prev, pressed = changed & state, released = changed & ~state 累计，
+// 每次 KEY_Update 取走一次，在下一次 KEY_Update 之前有效
+
+/**
+  * @brief  获取去抖后的按住集合
+  */
+uint8_t KEY_GetHeldMask();
+
+/**
+  * @brief  获取本次 KEY_Update 的按下集合
+  */
+uint8_t KEY_GetPressedMask();
+
+/**
+  * @brief  获取本次 KEY_Update 的释放集合
+  */
+uint8_t KEY_GetReleasedMask();
+
+/**
+  * @brief  获取本次 KEY_Update 的变化集合 (按下集合 | 释放集合)
+  */
+uint8_t KEY_GetChangedMask();
+
+/**
+  * @brief  设置去抖窗口
+  * @param  ms 状态需要稳定的时间 (1-255ms)
+  */
+void KEY_SetDebounce(uint8_t ms);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,105 @@
+/**
+  ******************************************************************************
+  * @file    keymap.h
+  * @brief   键位层 (layer) 栈头文件
+  * @note    每个预设最多 KM_MAX_LAYERS 层，层 0 为基础层；高层的透明键落到下方第一个非透明层
+  ******************************************************************************
+  */
+
+#ifndef __KEYMAP_H__
+#define __KEYMAP_H__
+
+#include <Arduino.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =================================================================================
+// 宏定义与结构体
+// =================================================================================
+
+#define KM_MAX_LAYERS 16 // 每个预设的最大层数 (含基础层)
+#define KM_KEY_COUNT 5   // 物理按键数
+#define KM_ENTRY_LEN 8   // 每个键位的长度 (同 HID 报文)
+
+/*
+ * 键位格式与 HID 报文相同: [修饰键, 标记, 键码1 ... 键码6]
+ * 报文的 Byte 1 为保留位，合成器不使用，这里用作标记：
+ *   0x00: 普通键位，整行作为报文发送
+ *   其他: 层操作 (Byte 2 为目标层) 或宏 (Byte 2 为宏序号)
+ */
+#define KM_TAG_KEY  0x00 // 普通键位
+#define KM_TAG_TRNS 0x01 // 透明：使用下方层的键位
+#define KM_TAG_MO   0x02 // 按住期间激活目标层 (momentary)
+#define KM_TAG_TG   0x03 // 每次按下切换目标层 (toggle)
+#define KM_TAG_OSL  0x04 // 只对下一个按键生效 (one-shot)；按住时等同 MO
+#define KM_TAG_MACRO 0x05 // 执行宏，Byte 2 为宏序号 (见 macro.h)
+
+// 键位初始化辅助宏
+#define KM_TRNS     {0x00, KM_TAG_TRNS, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}
+#define KM_MO(l)    {0x00, KM_TAG_MO, (l), 0x00, 0x00, 0x00, 0x00, 0x00}
+#define KM_TG(l)    {0x00, KM_TAG_TG, (l), 0x00, 0x00, 0x00, 0x00, 0x00}
+#define KM_OSL(l)   {0x00, KM_TAG_OSL, (l), 0x00, 0x00, 0x00, 0x00, 0x00}
+#define KM_MACRO(n) {0x00, KM_TAG_MACRO, (n), 0x00, 0x00, 0x00, 0x00, 0x00}
+
+/** * @brief 单层键位表
+ */
+typedef uint8_t KM_Layer[KM_KEY_COUNT][KM_ENTRY_LEN];
+
+// =================================================================================
+// 函数原型
+// =================================================================================
+
+/**
+  * @brief  切换键位表 (只交换指针，不复制)
+  * @param  base   基础层 (层 0)
+  * @param  layers 上层数组 (层 1 起)，可为 NULL
+  * @param  count  上层数量，超出 KM_MAX_LAYERS - 1 的部分忽略
+  */
+void KM_SetKeymap(const KM_Layer base, const KM_Layer *layers, uint8_t count);
+
+/**
+  * @brief  查找按键在当前激活层中的键位，O(1)
+  * @param  key 按键索引 (0-4)
+  * @retval 8 字节键位
+  */
+const uint8_t *KM_Resolve(uint8_t key);
+
+/**
+  * @brief  按键按下：查找键位并执行层操作，键位保存到该键释放为止
+  * @param  key 按键索引 (0-4)
+  * @retval 需要调用方处理的键位 (普通报文或 KM_TAG_MACRO)，层操作返回 NULL
+  */
+const uint8_t *KM_KeyDown(uint8_t key);
+
+/**
+  * @brief  按键释放：结束按下时查到的键位 (释放时的层状态不影响结果)
+  * @param  key 按键索引 (0-4)
+  * @retval bool 按下时是否发送了报文 (需要从报文中移除)
+  */
+bool KM_KeyUp(uint8_t key);
+
+/**
+  * @brief  激活/关闭/切换一层 (层 0 始终激活)
+  */
+void KM_LayerOn(uint8_t layer);
+void KM_LayerOff(uint8_t layer);
+void KM_LayerToggle(uint8_t layer);
+
+/**
+  * @brief  获取/设置激活层掩码 (bit n 对应层 n)
+  */
+uint16_t KM_GetLayerMask();
+void KM_SetLayerMask(uint16_t mask);
+
+/**
+  * @brief  获取最高的激活层
+  */
+uint8_t KM_GetTopLayer();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,119 @@
+/**
+  ******************************************************************************
+  * @file    macro.h
+  * @brief   非阻塞宏引擎头文件
+  * @note    宏为紧凑的字节码序列 (按下/释放/轻按/延时/文本)，由主循环按发送配额逐步执行
+  ******************************************************************************
+  */
+
+#ifndef __MACRO_H__
+#define __MACRO_H__
+
+#include <Arduino.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =================================================================================
+// 宏定义与结构体
+// =================================================================================
+
+#define MAC_MAX_MACROS 16 // 宏表最大长度
+#define MAC_TX_RESERVE 4  // 发送队列为实时按键保留的空位
+#define MAC_SOURCE 6      // 宏报文使用的报文来源索引 (物理按键 0-4，组合键 5)
+
+/*
+ * 字节码格式 (每条指令 1 字节操作码 + 参数)：
+ *   MAC_OP_PRESS   修饰键, 键码   按下 (加入宏报文)
+ *   MAC_OP_RELEASE 修饰键, 键码   释放 (从宏报文移除)
+ *   MAC_OP_TAP     修饰键, 键码   按下后释放 (两个报文)
+ *   MAC_OP_DELAY   ms 低字节, ms 高字节
+ *   MAC_OP_TEXT    ASCII 字符..., 0   逐字符轻按 (美式布局，见 HidAscii.h)
+ *   MAC_OP_END                     结束，释放宏仍按住的键
+ */
+#define MAC_OP_END     0x00
+#define MAC_OP_PRESS   0x01
+#define MAC_OP_RELEASE 0x02
+#define MAC_OP_TAP     0x03
+#define MAC_OP_DELAY   0x04
+#define MAC_OP_TEXT    0x05
+
+// 宏定义辅助宏，例如：
+// static const uint8_t m[] = {MAC_TAP(0x01, 0x04), MAC_DELAY(50), MAC_OP_TEXT, 'o', 'k', 0, MAC_END};
+#define MAC_PRESS(m, k)   MAC_OP_PRESS, (m), (k)
+#define MAC_RELEASE(m, k) MAC_OP_RELEASE, (m), (k)
+#define MAC_TAP(m, k)     MAC_OP_TAP, (m), (k)
+#define MAC_DELAY(ms)     MAC_OP_DELAY, ((ms) & 0xFF), (((ms) >> 8) & 0xFF)
+#define MAC_END           MAC_OP_END
+
+/** * @brief 宏报文输出回调
+ * @param report 8 字节报文 (格式同预设键位)，NULL 表示宏已释放全部按键
+ */
+typedef void (*MAC_Output)(const uint8_t *report);
+
+/** * @brief 宏引擎统计
+ */
+typedef struct {
+    uint32_t runs;        // 执行完成的宏数
+    uint32_t aborted;     // 被中止的宏数
+    uint32_t busy;        // 因已有宏在执行而被忽略的启动次数
+    uint32_t reports;     // 输出的报文数
+    uint32_t rate;        // 最近一次宏的吞吐 (报文/秒，不含延时指令的等待时间)
+    uint32_t peakRate;    // 历史最高吞吐 (报文/秒)
+    uint32_t stepErrAvgUs; // 延时到期后的指令实际执行时间与到期时间之差的平均值 (us)
+    uint32_t stepErrMaxUs; // 同上，最大值 (us)
+} MAC_Stats;
+
+// =================================================================================
+// 函数原型
+// =================================================================================
+
+/**
+  * @brief  初始化宏引擎
+  * @param  out 报文输出回调
+  */
+void MAC_Init(MAC_Output out);
+
+/**
+  * @brief  设置宏表 (只保存指针)
+  * @param  macros 字节码指针数组
+  * @param  count  宏数，超出 MAC_MAX_MACROS 的部分忽略
+  */
+void MAC_SetTable(const uint8_t *const *macros, uint8_t count);
+
+/**
+  * @brief  开始执行一个宏
+  * @param  index 宏序号
+  * @retval bool 是否已开始 (序号无效或已有宏在执行时返回 false)
+  */
+bool MAC_Start(uint8_t index);
+
+/**
+  * @brief  中止正在执行的宏 (不输出报文，由调用方清空宏报文)
+  */
+void MAC_Stop();
+
+/**
+  * @brief  推进宏执行 (主循环调用)，不阻塞
+  * @param  now    当前时间 (esp_timer_get_time() 低 32 位, us)
+  * @param  budget 本次最多可输出的报文数
+  * @retval 本次输出的报文数
+  */
+uint8_t MAC_Update(uint32_t now, uint8_t budget);
+
+/**
+  * @brief  是否有宏在执行
+  */
+bool MAC_IsRunning();
+
+/**
+  * @brief  获取宏引擎统计
+  */
+void MAC_GetStats(MAC_Stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -12,12 +12,27 @@ extern "C" {
 #endif
 
 #define OLED_IIC_ADDR 0x78
+#define OLED_IIC_FREQ 400000 // 硬件 I2C 后端的总线时钟
+
+// 显存尺寸：按 128x32 屏幕分配 (4 页 x 128 列 = 512 字节)
+#define OLED_WIDTH      128
+#define OLED_MAX_HEIGHT 32
+#define OLED_PAGES      (OLED_MAX_HEIGHT / 8)
+
+// 后台刷新任务
+#define OLED_TASK_STACK     3072
+#define OLED_TASK_PRIORITY  1  // 与 loop() 相同，软件IIC发送时与主循环轮流占用 CPU
+#define OLED_CMD_QUEUE_LEN  16 // 控制命令队列深度
+#define OLED_CMD_MAX_LEN    4  // 单个命令包最多字节数
 
-void OLED_SetCursor(uint8_t x, uint8_t y);
 void OLED_Clear();
 void OLED_ClearPart(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2);
 
-void OLED_Init(uint8_t scl, uint8_t sda, uint8_t height, uint8_t bus);
+bool OLED_Flush();
+bool OLED_IsBusy();
+void OLED_SetFlushCallback(void (*cb)(void));
+
+void OLED_Init(uint8_t scl, uint8_t sda, uint8_t height, uint8_t bus, uint8_t backend);
 
 void OLED_PrintText(uint8_t x, uint8_t y, const char* str, uint8_t size);
 void OLED_PrintImage(uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t* image);
@@ -25,8 +40,10 @@ void OLED_PrintVar(uint8_t x, uint8_t y, float num, const char* type, uint8_t le
 void OLED_PrintHLine(uint8_t x, uint8_t y, uint8_t width);
 void OLED_PrintVLine(uint8_t x, uint8_t y, uint8_t height);
 
+void OLED_SetContrast(uint8_t contrast);
 void OLED_LowBrightness(bool lowBrightness);
 void OLED_Power(bool state);
+void OLED_GetCmdStats(uint32_t* sent, uint32_t* suppressed);
 
 #ifdef __cplusplus
 }
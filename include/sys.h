@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include <Preferences.h>
 #include "key.h"
+#include "keymap.h"
 #include "battery.h"
 #include "def.h"
 #include "Hid2Ble.h"
@@ -12,9 +13,12 @@ typedef enum {
     MODE_NORMAL,
     MODE_TIMER_SET,
     MODE_METRONOME,
-    MODE_KEY_CONFIG
+    MODE_KEY_CONFIG,
+    MODE_HOST_SELECT
 } SystemMode;
 
+#define MODE_COUNT 5
+
 struct SystemStatus {
     bool bleConnected;
     unsigned long lastLedUpdate;
@@ -23,9 +27,11 @@ struct SystemStatus {
 #define PRESET_COUNT 6 // Add extra preset number here
 
 typedef struct {
-    uint8_t keymap[5][8];
+    uint8_t keymap[5][8];          // 基础层 (层 0)
     uint8_t name[20];
     uint8_t keyDescription[5][16];
+    const KM_Layer *layers;        // 上层 (层 1 起)，NULL 表示只有基础层
+    uint8_t layerCount;            // 上层数量 (最多 KM_MAX_LAYERS - 1)
 } KeyPreset;
 
 extern KeyPreset presets[PRESET_COUNT]; // Add preset in this array
@@ -35,15 +41,22 @@ extern SystemMode currentMode;
 extern struct SystemStatus sysStatus;
 extern bool active;
 extern bool changeName;
+extern uint8_t hostSlotSel;
 
 extern Hid2Ble keybrick;
 
 void KEY_Detect();
+void SYS_TimerTick();
 void BLE_UpdateBAT();
 void KEY_Send();
+void SYS_MacroUpdate();
+void SYS_TextUpdate();
+void KEY_ReleaseAll();
 
-void SYS_ModeSwitch();
+void SYS_KeyActionInit();
+void SYS_ModeSwitch(SystemMode mode);
 void SYS_KeyConfig();
+void SYS_HostSelect();
 void SYS_SavePreset();
 void SYS_LoadPreset();
 void SYS_ConfirmPreset(uint8_t preset);
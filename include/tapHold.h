@@ -0,0 +1,117 @@
+/**
+  ******************************************************************************
+  * @file    tapHold.h
+  * @brief   轻按/按住 (tap-hold) 判定引擎头文件
+  * @note    每个按键可绑定一个轻按动作和一个按住动作，由按键事件驱动的状态机判定
+  ******************************************************************************
+  */
+
+#ifndef __TAP_HOLD_H__
+#define __TAP_HOLD_H__
+
+#include <Arduino.h>
+#include "key.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =================================================================================
+// 宏定义与结构体
+// =================================================================================
+
+#define TH_KEY_COUNT 5          // 物理按键数
+#define TH_TAPPING_TERM_MS 200  // 默认判定时间 (单位: ms)
+#define TH_BUFFER_LEN 8         // 判定期间可缓存的其他按键事件数
+
+// 绑定选项 (TH_Binding.flags)
+#define TH_PERMISSIVE_HOLD 0x01 // 判定期间另一个键完成了按下+释放，立即判定为按住
+#define TH_RETRO_TAP       0x02 // 按住后未按其他键就释放，补发一次轻按动作
+#define TH_EAGER_TAP       0x04 // 按下立即触发轻按动作 (不等待判定)，按住到判定时间再额外触发按住动作，
+                                // 用于普通按键附带长按功能：按键行为 (含主机自动重复) 与普通按键相同
+
+/** * @brief 动作类型
+ */
+typedef enum {
+    ACT_NONE = 0, // 无动作 (未绑定按住动作的键按下即触发轻按动作)
+    ACT_REPORT,   // 8 字节 HID 报文 (report 指向报文，格式同预设键位)
+    ACT_MODS,     // 仅修饰键 (arg 为修饰键字节)
+    ACT_MODE,     // 切换系统模式 (arg 为 SystemMode)，只在按下时生效
+    ACT_KEYMAP,   // 按当前激活层查找键位 (keymap)
+    ACT_LAYER,    // 按住期间激活一层 (arg 为层号)，用于 layer-tap
+    ACT_MACRO,    // 执行宏 (arg 为宏序号)，只在按下时生效
+    ACT_TEXT      // 输入文本 (report 指向以 0 结尾的 ASCII 字符串，Hid2Ble::typeString)，只在按下时生效
+} KeyActionType;
+
+/** * @brief 按键动作
+ */
+typedef struct {
+    uint8_t type;           // KeyActionType
+    uint8_t arg;            // 修饰键 / 模式
+    const uint8_t *report;  // ACT_REPORT 的报文 / ACT_TEXT 的字符串
+} KeyAction;
+
+/** * @brief 单个按键的绑定
+ */
+typedef struct {
+    KeyAction tap;   // 轻按动作
+    KeyAction hold;  // 按住动作，ACT_NONE 表示普通按键
+    uint16_t termMs; // 判定时间：按下超过该时间判定为按住
+    uint8_t flags;   // TH_PERMISSIVE_HOLD / TH_RETRO_TAP / TH_EAGER_TAP
+} TH_Binding;
+
+/** * @brief 判定结果的输出回调
+ * @param key  按键索引 (0-4)，可直接作为 HID 报文来源索引
+ * @param act  触发的动作
+ * @param down true = 动作开始，false = 动作结束
+ */
+typedef void (*TH_ActionSink)(uint8_t key, const KeyAction *act, bool down);
+
+/** * @brief 引擎统计
+ */
+typedef struct {
+    uint32_t taps;            // 判定为轻按的次数
+    uint32_t holds;           // 判定为按住的次数 (含宽松判定)
+    uint32_t permissiveHolds; // 其中由宽松判定触发的次数
+    uint32_t retroTaps;       // 补发的轻按次数
+    uint32_t buffered;        // 判定期间被缓存的事件数
+    uint32_t overflow;        // 缓存已满而提前判定为按住的次数
+    uint32_t maxResolveUs;    // 最大判定延迟 (按下到判定完成，按中断时间戳计)
+} TH_Stats;
+
+// =================================================================================
+// 函数原型
+// =================================================================================
+
+/**
+  * @brief  初始化引擎
+  * @param  sink 动作输出回调
+  */
+void TH_Init(TH_ActionSink sink);
+
+/**
+  * @brief  设置按键绑定，同时设置该键的保持时间 (KEY_SetHoldTime)
+  * @param  key    按键索引 (0-4)
+  * @param  tap    轻按动作
+  * @param  hold   按住动作，NULL 或 ACT_NONE 表示普通按键
+  * @param  termMs 判定时间，0 表示使用 TH_TAPPING_TERM_MS
+  * @param  flags  TH_PERMISSIVE_HOLD / TH_RETRO_TAP / TH_EAGER_TAP
+  */
+void TH_SetBinding(uint8_t key, const KeyAction *tap, const KeyAction *hold, uint16_t termMs, uint8_t flags);
+
+/**
+  * @brief  处理一个按键事件 (KEY_SetEventCallback 回调，主循环上下文)
+  * @param  evt 按下/释放/保持事件 (其他事件忽略)
+  */
+void TH_Process(const KeyEvent *evt);
+
+/**
+  * @brief  获取引擎统计
+  */
+void TH_GetStats(TH_Stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
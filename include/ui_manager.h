@@ -6,6 +6,7 @@
 #include "sys.h"
 #include "battery.h"
 #include "timerMetronome.h"
+#include "ui_widget.h"
 
 class UIManager
 {
@@ -16,21 +17,30 @@ public:
     static void setLowBattery(bool isLow);
     static void resetScroll();
     static bool isScreenOn();
+    static void setFrameRate(SystemMode mode, uint8_t fps, uint16_t budgetUs);
 
 private:
     static void checkTimeout();
-    static void drawStatusBar();
-    static void drawKeyDesc();
-    static void timerDisplay();
+    static void onFrameDone();
 
     // 屏幕超时参数
     static const uint32_t SCREEN_ALMOST_TIMEOUT = 5000;
     static const uint32_t SCREEN_TIMEOUT = 10000;
 
+    // 帧调度参数：每个模式的目标帧率与单帧渲染时间预算
+    struct FrameConfig
+    {
+        uint8_t fps;
+        uint16_t budgetUs;
+    };
+    static FrameConfig frameConfig[MODE_COUNT]; // 按 SystemMode 顺序
+
     // 状态变量
     static uint32_t lastActivityTime;
     static bool screenOn;
-    static uint8_t scrollPos;
+    static SystemMode shownMode; // 当前屏幕上显示的是哪个模式的界面
+    static uint32_t lastFrameTime;
+    static volatile bool frameInFlight; // 已提交的帧是否仍在后台发送
 };
 
 #endif
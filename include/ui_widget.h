@@ -0,0 +1,135 @@
+#ifndef __UI_WIDGET_H__
+#define __UI_WIDGET_H__
+
+#include <Arduino.h>
+#include "oled.h"
+
+/*
+ * 保留模式 (Retained-mode) 界面控件
+ * 每个控件绑定一个模型值 (通过 UIBinding 读取)，只有当绑定值变化或控件被标记失效时才重绘，
+ * 稳态帧不修改显存，也就不产生任何 I2C 流量。
+ * 坐标约定与 OLED_Print* 一致：x 为列 (0-127)，y 为页 (0-3)。
+ */
+
+typedef int32_t (*UIBinding)();
+typedef void (*UIFormatter)(char *buf, size_t size, int32_t value);
+
+class UIWidget
+{
+public:
+    UIWidget(uint8_t x, uint8_t y, uint8_t width, uint8_t height, UIBinding bind);
+
+    bool refresh();    // 绑定值变化 (或已失效) 时重绘，返回是否发生了绘制
+    void invalidate(); // 强制下一次 refresh() 重绘
+
+protected:
+    virtual int32_t value();               // 当前绑定值，默认读取 bind (无绑定时为常量)
+    virtual void render(int32_t value) = 0; // 按绑定值绘制到显存
+    void clearArea();                       // 清除控件占用的矩形区域
+
+    uint8_t x, y, width, height; // height 单位为页
+
+private:
+    UIBinding bind;
+    int32_t lastValue;
+    bool valid;
+};
+
+// 文本标签：固定文本，或由格式化函数把绑定值转换为文本
+class UILabel : public UIWidget
+{
+public:
+    UILabel(uint8_t x, uint8_t y, uint8_t width, const char *text, uint8_t size = 8);
+    UILabel(uint8_t x, uint8_t y, uint8_t width, UIBinding bind, UIFormatter format, uint8_t size = 8);
+
+protected:
+    void render(int32_t value) override;
+
+private:
+    const char *text;
+    UIFormatter format;
+    uint8_t size;
+};
+
+// 图标：静态位图，只在失效后绘制一次
+class UIIcon : public UIWidget
+{
+public:
+    UIIcon(uint8_t x, uint8_t y, uint8_t width, uint8_t height, const uint8_t *image);
+
+protected:
+    void render(int32_t value) override;
+
+private:
+    const uint8_t *image;
+};
+
+// 数值：定宽补零的整数 (6x8 字体)
+class UIValue : public UIWidget
+{
+public:
+    UIValue(uint8_t x, uint8_t y, uint8_t digits, UIBinding bind);
+
+protected:
+    void render(int32_t value) override;
+
+private:
+    uint8_t digits;
+};
+
+// 轮播：每隔 period 毫秒切换到下一项，可同时显示连续的多行
+// 绑定值变化 (例如预设切换) 时立即重绘当前项
+typedef void (*UIItemFormatter)(char *buf, size_t size, uint8_t index);
+
+class UIMarquee : public UIWidget
+{
+public:
+    UIMarquee(uint8_t x, uint8_t y, uint8_t width, uint8_t lines, uint8_t count, uint8_t itemCount,
+              uint32_t period, UIBinding bind, UIItemFormatter format);
+
+    void reset(); // 回到第一项并重新计时
+
+protected:
+    int32_t value() override;
+    void render(int32_t value) override;
+
+private:
+    uint8_t lines;     // 同时显示的行数
+    uint8_t count;     // 轮播位置个数
+    uint8_t itemCount; // 条目总数 (超出部分的行留空)
+    uint32_t period;
+    UIItemFormatter format;
+    uint8_t index;
+    uint32_t lastStep;
+};
+
+// 进度条：绑定值为 0-100，按比例填充 width 列
+class UIProgress : public UIWidget
+{
+public:
+    UIProgress(uint8_t x, uint8_t y, uint8_t width, UIBinding bind, uint8_t fill, uint8_t empty);
+
+protected:
+    void render(int32_t value) override;
+
+private:
+    uint8_t fill;  // 已填充列的像素字节
+    uint8_t empty; // 未填充列的像素字节
+};
+
+// 一个界面：控件指针数组
+class UIScreen
+{
+public:
+    UIScreen(UIWidget *const *widgets, uint8_t count);
+
+    bool refresh(uint32_t budgetUs); // 在时间预算内刷新控件，返回是否完成了一整轮
+    void invalidate();
+
+private:
+    UIWidget *const *widgets;
+    uint8_t count;
+    uint8_t next; // 上一帧超出预算时，下一帧从这个控件继续
+};
+
+#endif
@@ -1,10 +1,53 @@
 #include <Arduino.h>
 #include "BleConnectionStatus.h"
+#include "Hid2Ble.h"
 
 BleConnectionStatus::BleConnectionStatus(void)
 {
 }
 
+#if defined(HID2BLE_USE_NIMBLE)
+
+/**
+ * NimBLE 地址为低字节在前，统一转换为高字节在前 (与 Bluedroid 一致)
+ */
+static void copyAddr(uint8_t *dst, const uint8_t *src)
+{
+  for (int i = 0; i < 6; i++)
+  {
+    dst[i] = src[5 - i];
+  }
+}
+
+void BleConnectionStatus::onConnect(NimBLEServer *pServer, ble_gap_conn_desc *desc)
+{
+  copyAddr(this->remoteBda, desc->peer_ota_addr.val);
+  this->connId = desc->conn_handle;
+  this->connected = true;
+}
+
+void BleConnectionStatus::onDisconnect(NimBLEServer *pServer)
+{
+  this->connected = false;
+}
+
+void BleConnectionStatus::onAuthenticationComplete(ble_gap_conn_desc *desc)
+{
+  uint8_t addr[6];
+
+  if (!desc->sec_state.encrypted || this->owner == nullptr)
+  {
+    return;
+  }
+  copyAddr(addr, desc->peer_id_addr.val);
+  if (!this->owner->onHostAuthenticated(addr, desc->peer_id_addr.type))
+  {
+    NimBLEDevice::getServer()->disconnect(desc->conn_handle);
+  }
+}
+
+#else
+
 void BleConnectionStatus::onConnect(BLEServer *pServer)
 {
   Serial.print("framework bluetooth connected!");
@@ -14,6 +57,15 @@ void BleConnectionStatus::onConnect(BLEServer *pServer)
 
   desc = (BLE2902 *)this->inputMediaKeys->getDescriptorByUUID(BLEUUID((uint16_t)0x2902));
   desc->setNotifications(true);
+
+  desc = (BLE2902 *)this->inputNkro->getDescriptorByUUID(BLEUUID((uint16_t)0x2902));
+  desc->setNotifications(true);
+}
+
+void BleConnectionStatus::onConnect(BLEServer *pServer, esp_ble_gatts_cb_param_t *param)
+{
+  memcpy(this->remoteBda, param->connect.remote_bda, sizeof(this->remoteBda));
+  this->connId = param->connect.conn_id;
 }
 
 void BleConnectionStatus::onDisconnect(BLEServer *pServer)
@@ -25,4 +77,9 @@ void BleConnectionStatus::onDisconnect(BLEServer *pServer)
 
   desc = (BLE2902 *)this->inputMediaKeys->getDescriptorByUUID(BLEUUID((uint16_t)0x2902));
   desc->setNotifications(false);
+
+  desc = (BLE2902 *)this->inputNkro->getDescriptorByUUID(BLEUUID((uint16_t)0x2902));
+  desc->setNotifications(false);
 }
+
+#endif
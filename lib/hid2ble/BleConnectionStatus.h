@@ -3,11 +3,21 @@
 #include "sdkconfig.h"
 #if defined(CONFIG_BT_ENABLED)
 
+#if defined(HID2BLE_USE_NIMBLE)
+#include <NimBLEServer.h>
+#else
 #include <BLEServer.h>
 #include "BLE2902.h"
 #include "BLECharacteristic.h"
+#endif
+
+class Hid2Ble;
 
+#if defined(HID2BLE_USE_NIMBLE)
+class BleConnectionStatus : public NimBLEServerCallbacks
+#else
 class BleConnectionStatus : public BLEServerCallbacks
+#endif
 {
 public:
   BleConnectionStatus(void);
@@ -16,10 +26,28 @@ public:
    * 蓝牙连接状态
    */
   bool connected = false;
+#if defined(HID2BLE_USE_NIMBLE)
+  /**
+   * 蓝牙连接回调函数
+   */
+  void onConnect(NimBLEServer *pServer, ble_gap_conn_desc *desc);
+  /**
+   * 蓝牙断开连接回调函数
+   */
+  void onDisconnect(NimBLEServer *pServer);
+  /**
+   * 认证 (配对/加密) 完成回调函数，只接受当前槽位的主机
+   */
+  void onAuthenticationComplete(ble_gap_conn_desc *desc);
+#else
   /**
    * 蓝牙连接回调函数
    */
   void onConnect(BLEServer *pServer);
+  /**
+   * 蓝牙连接回调函数 (带连接参数，用于记录对端地址)
+   */
+  void onConnect(BLEServer *pServer, esp_ble_gatts_cb_param_t *param);
   /**
    * 蓝牙断开连接回调函数
    */
@@ -27,6 +55,17 @@ public:
   BLECharacteristic *inputKeyboard;
   BLECharacteristic *outputKeyboard;
   BLECharacteristic *inputMediaKeys;
+  BLECharacteristic *inputNkro;
+#endif
+  /**
+   * 当前连接的对端地址 (高字节在前) 与连接 ID / 句柄
+   */
+  uint8_t remoteBda[6];
+  uint16_t connId = 0;
+  /**
+   * 所属的 Hid2Ble 对象
+   */
+  Hid2Ble *owner = nullptr;
 };
 
 #endif
@@ -1,113 +1,59 @@
-#include <BLEDevice.h>
-#include <BLEUtils.h>
-#include <BLEServer.h>
-#include "BLE2902.h"
-#include "BLEHIDDevice.h"
-#include "HIDTypes.h"
-#include <driver/adc.h>
+/**
+ * Hid2Ble 传输层无关部分：报文队列、连接参数档位、断线重连与主机槽位。
+ * 协议栈相关实现见 Hid2BleBluedroid.cpp (默认) 与 Hid2BleNimBLE.cpp (HID2BLE_USE_NIMBLE)
+ */
 #include "sdkconfig.h"
+#include "Hid2Ble.h"
+#if defined(CONFIG_BT_ENABLED)
 
 #include "BleConnectionStatus.h"
-#include "Hid2Ble.h"
-#include "BLECharacteristic.h"
-
-// Report IDs:
-#define KEYBOARD_ID 0x01
-#define MEDIA_KEYS_ID 0x02
-
-static const uint8_t _hidReportDescriptor[] = {
-	USAGE_PAGE(1), 0x01, // USAGE_PAGE (Generic Desktop Ctrls)
-	USAGE(1), 0x06,		 // USAGE (Keyboard)
-	COLLECTION(1), 0x01, // COLLECTION (Application)
-	// ------------------------------------------------- Keyboard
-	REPORT_ID(1), KEYBOARD_ID, //   REPORT_ID (1)
-	USAGE_PAGE(1), 0x07,	   //   USAGE_PAGE (Kbrd/Keypad)
-	USAGE_MINIMUM(1), 0xE0,	   //   USAGE_MINIMUM (0xE0)
-	USAGE_MAXIMUM(1), 0xE7,	   //   USAGE_MAXIMUM (0xE7)
-	LOGICAL_MINIMUM(1), 0x00,  //   LOGICAL_MINIMUM (0)
-	LOGICAL_MAXIMUM(1), 0x01,  //   Logical Maximum (1)
-	REPORT_SIZE(1), 0x01,	   //   REPORT_SIZE (1)
-	REPORT_COUNT(1), 0x08,	   //   REPORT_COUNT (8)
-	HIDINPUT(1), 0x02,		   //   INPUT (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position)
-	REPORT_COUNT(1), 0x01,	   //   REPORT_COUNT (1) ; 1 byte (Reserved)
-	REPORT_SIZE(1), 0x08,	   //   REPORT_SIZE (8)
-	HIDINPUT(1), 0x01,		   //   INPUT (Const,Array,Abs,No Wrap,Linear,Preferred State,No Null Position)
-	REPORT_COUNT(1), 0x05,	   //   REPORT_COUNT (5) ; 5 bits (Num lock, Caps lock, Scroll lock, Compose, Kana)
-	REPORT_SIZE(1), 0x01,	   //   REPORT_SIZE (1)
-	USAGE_PAGE(1), 0x08,	   //   USAGE_PAGE (LEDs)
-	USAGE_MINIMUM(1), 0x01,	   //   USAGE_MINIMUM (0x01) ; Num Lock
-	USAGE_MAXIMUM(1), 0x05,	   //   USAGE_MAXIMUM (0x05) ; Kana
-	HIDOUTPUT(1), 0x02,		   //   OUTPUT (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-	REPORT_COUNT(1), 0x01,	   //   REPORT_COUNT (1) ; 3 bits (Padding)
-	REPORT_SIZE(1), 0x03,	   //   REPORT_SIZE (3)
-	HIDOUTPUT(1), 0x01,		   //   OUTPUT (Const,Array,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
-	REPORT_COUNT(1), 0x06,	   //   REPORT_COUNT (6) ; 6 bytes (Keys)
-	REPORT_SIZE(1), 0x08,	   //   REPORT_SIZE(8)
-	LOGICAL_MINIMUM(1), 0x00,  //   LOGICAL_MINIMUM(0)
-	LOGICAL_MAXIMUM(1), 0x65,  //   LOGICAL_MAXIMUM(0x65) ; 101 keys
-	USAGE_PAGE(1), 0x07,	   //   USAGE_PAGE (Kbrd/Keypad)
-	USAGE_MINIMUM(1), 0x00,	   //   USAGE_MINIMUM (0)
-	USAGE_MAXIMUM(1), 0x65,	   //   USAGE_MAXIMUM (0x65)
-	HIDINPUT(1), 0x00,		   //   INPUT (Data,Array,Abs,No Wrap,Linear,Preferred State,No Null Position)
-	END_COLLECTION(0),		   // END_COLLECTION
-	// ------------------------------------------------- Media Keys
-	USAGE_PAGE(1), 0x0C,		 // USAGE_PAGE (Consumer)
-	USAGE(1), 0x01,				 // USAGE (Consumer Control)
-	COLLECTION(1), 0x01,		 // COLLECTION (Application)
-	REPORT_ID(1), MEDIA_KEYS_ID, //   REPORT_ID (3)
-	USAGE_PAGE(1), 0x0C,		 //   USAGE_PAGE (Consumer)
-	LOGICAL_MINIMUM(1), 0x00,	 //   LOGICAL_MINIMUM (0)
-	LOGICAL_MAXIMUM(1), 0x01,	 //   LOGICAL_MAXIMUM (1)
-	REPORT_SIZE(1), 0x01,		 //   REPORT_SIZE (1)
-	REPORT_COUNT(1), 0x10,		 //   REPORT_COUNT (16)
-	USAGE(1), 0xB5,				 //   USAGE (Scan Next Track)     ; bit 0: 1
-	USAGE(1), 0xB6,				 //   USAGE (Scan Previous Track) ; bit 1: 2
-	USAGE(1), 0xB7,				 //   USAGE (Stop)                ; bit 2: 4
-	USAGE(1), 0xCD,				 //   USAGE (Play/Pause)          ; bit 3: 8
-	USAGE(1), 0xE2,				 //   USAGE (Mute)                ; bit 4: 16
-	USAGE(1), 0xE9,				 //   USAGE (Volume Increment)    ; bit 5: 32
-	USAGE(1), 0xEA,				 //   USAGE (Volume Decrement)    ; bit 6: 64
-	USAGE(2), 0x23, 0x02,		 //   Usage (WWW Home)            ; bit 7: 128
-	USAGE(2), 0x94, 0x01,		 //   Usage (My Computer) ; bit 0: 1
-	USAGE(2), 0x92, 0x01,		 //   Usage (Calculator)  ; bit 1: 2
-	USAGE(2), 0x2A, 0x02,		 //   Usage (WWW fav)     ; bit 2: 4
-	USAGE(2), 0x21, 0x02,		 //   Usage (WWW search)  ; bit 3: 8
-	USAGE(2), 0x26, 0x02,		 //   Usage (WWW stop)    ; bit 4: 16
-	USAGE(2), 0x24, 0x02,		 //   Usage (WWW back)    ; bit 5: 32
-	USAGE(2), 0x83, 0x01,		 //   Usage (Media sel)   ; bit 6: 64
-	USAGE(2), 0x8A, 0x01,		 //   Usage (Mail)        ; bit 7: 128
-	HIDINPUT(1), 0x02,			 //   INPUT (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position)
-	END_COLLECTION(0),			 // END_COLLECTION
-
-
-// Additional report map for Brightness control
-
-	// USAGE_PAGE(1), 0x80,        // USAGE_PAGE (Monitor Control)
-	// USAGE(1), 0x01,             // USAGE (Monitor Brightness)
-	// COLLECTION(1), 0x01,        // COLLECTION (Application)
-	// REPORT_ID(1), 0x03,         //   REPORT_ID (3)
-	// LOGICAL_MINIMUM(1), 0x00,   //   LOGICAL_MINIMUM (0)
-	// LOGICAL_MAXIMUM(1), 0xFF,   //   LOGICAL_MAXIMUM (255)
-	// REPORT_SIZE(1), 0x08,       //   REPORT_SIZE (8)
-	// REPORT_COUNT(1), 0x01,      //   REPORT_COUNT (1)
-	// USAGE(1), 0x6F,             //   USAGE (Brightness Up)
-	// USAGE(1), 0x70,             //   USAGE (Brightness Down)
-	// HIDINPUT(1), 0x02,          //   INPUT (Data,Var,Abs)
-	// END_COLLECTION(0)           // END_COLLECTION
-
-};
-
-Hid2Ble::Hid2Ble(std::string deviceName, std::string deviceManufacturer, uint8_t batteryLevel) : hid(0)
+#include "HidDescriptor.h"
+#include "esp_timer.h"
+#include <Preferences.h>
+
+Hid2Ble *Hid2Ble::instance = NULL;
+
+Hid2Ble::Hid2Ble(std::string deviceName, std::string deviceManufacturer, uint8_t batteryLevel)
 {
 	this->deviceName = deviceName;
 	this->deviceManufacturer = deviceManufacturer;
 	this->batteryLevel = batteryLevel;
 	this->connectionStatus = new BleConnectionStatus();
-}
+	this->connectionStatus->owner = this;
 
-void Hid2Ble::begin(void)
-{
-	xTaskCreate(this->taskServer, "server", 20000, (void *)this, 5, NULL);
+	this->txHead = 0;
+	this->txCount = 0;
+	memset(this->lastTaken, 0, sizeof(this->lastTaken));
+	this->txMux = portMUX_INITIALIZER_UNLOCKED;
+	this->txTaskHandle = NULL;
+	memset(&this->txStats, 0, sizeof(this->txStats));
+	this->txLatencySum = 0;
+	this->txPerEvent = HID2BLE_TX_PER_EVENT;
+	this->txIntervalUs = HID2BLE_TX_INTERVAL_US;
+	this->txTokens = HID2BLE_TX_PER_EVENT;
+	this->txLastRefill = 0;
+
+	this->typing = false;
+	this->typeStop = false;
+	this->typeStart = 0;
+	this->typeReports = 0;
+	memset(&this->typeStats, 0, sizeof(this->typeStats));
+
+	memset(&this->connParams, 0, sizeof(this->connParams));
+	this->lastActivity = 0;
+
+	this->started = false;
+	memset(this->hostSlots, 0, sizeof(this->hostSlots));
+	this->activeSlot = 0;
+	this->hostDirty = false;
+	this->hostAccepted = false;
+	this->rejectedHosts = 0;
+	this->wasConnected = false;
+	this->advPhase = HID2BLE_ADV_NONE;
+	this->advPhaseStart = 0;
+	this->disconnectTime = 0;
+	memset(&this->reconnectStats, 0, sizeof(this->reconnectStats));
+	instance = this;
 }
 
 void Hid2Ble::end(void)
@@ -119,76 +65,724 @@ bool Hid2Ble::isConnected(void)
 	return this->connectionStatus->connected;
 }
 
-void Hid2Ble::setBatteryLevel(uint8_t level)
+void Hid2Ble::setCallBack(Hid2BleCharacteristicCallbacks *callBack)
 {
-	this->batteryLevel = level;
-	this->hid->setBatteryLevel(this->batteryLevel);
+	this->callBack = callBack;
 }
 
-void Hid2Ble::setCallBack(BLECharacteristicCallbacks *callBack)
+bool Hid2Ble::send2Ble(char *keys)
 {
-	this->callBack = callBack;
+	return this->isConnected() && this->enqueue(KEYBOARD_ID, (uint8_t *)keys, 8);
+}
+bool Hid2Ble::sendNkro2Ble(const uint8_t *bitmap)
+{
+	return this->isConnected() && this->enqueue(NKRO_KEYS_ID, bitmap, HID2BLE_NKRO_LEN);
+}
+void Hid2Ble::sendMedia2Ble(char *keys)
+{
+	if (this->isConnected())
+	{
+		this->enqueue(MEDIA_KEYS_ID, (uint8_t *)keys, 2);
+	}
 }
 
-void Hid2Ble::taskServer(void *pvParameter)
+// =================================================================================
+// 连接参数协商
+// =================================================================================
+
+/**
+ * 向主机请求指定档位的连接参数
+ */
+void Hid2Ble::requestConnParams(uint8_t profile)
 {
-	Hid2Ble *bleKeyboardInstance = (Hid2Ble *)pvParameter; //static_cast<BleKeyboard *>(pvParameter);
-	BLEDevice::init(bleKeyboardInstance->deviceName);
-	BLEServer *pServer = BLEDevice::createServer();
-	pServer->setCallbacks(bleKeyboardInstance->connectionStatus);
+	if (profile == HID2BLE_PROFILE_ACTIVE)
+	{
+		this->sendConnParams(HID2BLE_ACTIVE_MIN_INT, HID2BLE_ACTIVE_MAX_INT, HID2BLE_ACTIVE_LATENCY, HID2BLE_ACTIVE_TIMEOUT);
+	}
+	else
+	{
+		this->sendConnParams(HID2BLE_IDLE_MIN_INT, HID2BLE_IDLE_MAX_INT, HID2BLE_IDLE_LATENCY, HID2BLE_IDLE_TIMEOUT);
+	}
+	this->connParams.profile = profile;
+}
 
-	bleKeyboardInstance->hid = new BLEHIDDevice(pServer);
-	bleKeyboardInstance->inputKeyboard = bleKeyboardInstance->hid->inputReport(KEYBOARD_ID); // <-- input REPORTID from report map
-	bleKeyboardInstance->outputKeyboard = bleKeyboardInstance->hid->outputReport(KEYBOARD_ID);
-	bleKeyboardInstance->inputMediaKeys = bleKeyboardInstance->hid->inputReport(MEDIA_KEYS_ID);
-	bleKeyboardInstance->connectionStatus->inputKeyboard = bleKeyboardInstance->inputKeyboard;
-	bleKeyboardInstance->connectionStatus->outputKeyboard = bleKeyboardInstance->outputKeyboard;
-	bleKeyboardInstance->connectionStatus->inputMediaKeys = bleKeyboardInstance->inputMediaKeys;
+void Hid2Ble::onActivity(void)
+{
+	this->lastActivity = millis();
+	if (this->isConnected() && this->connParams.profile != HID2BLE_PROFILE_ACTIVE)
+	{
+		this->requestConnParams(HID2BLE_PROFILE_ACTIVE);
+	}
+}
 
-	bleKeyboardInstance->outputKeyboard->setCallbacks(bleKeyboardInstance->callBack);
+void Hid2Ble::updateConnProfile(void)
+{
+	if (!this->isConnected())
+	{
+		// 断开后清除档位，下次连接重新协商
+		if (this->connParams.profile != HID2BLE_PROFILE_NONE)
+		{
+			this->connParams.profile = HID2BLE_PROFILE_NONE;
+			this->connParams.valid = false;
+		}
+		return;
+	}
+
+	this->refreshConnParams();
+
+	if (this->connParams.profile == HID2BLE_PROFILE_NONE)
+	{
+		// 刚建立连接：先用活跃参数，让配对与首次按键都走短间隔
+		this->lastActivity = millis();
+		this->requestConnParams(HID2BLE_PROFILE_ACTIVE);
+	}
+	else if (this->connParams.profile == HID2BLE_PROFILE_ACTIVE && millis() - this->lastActivity > HID2BLE_IDLE_TIMEOUT_MS)
+	{
+		this->requestConnParams(HID2BLE_PROFILE_IDLE);
+	}
+}
+
+void Hid2Ble::getConnParams(Hid2BleConnParams *params)
+{
+	*params = this->connParams;
+}
+
+/**
+ * 主机确认了新的连接参数 (协议栈回调或轮询中调用)
+ */
+void Hid2Ble::onConnParamsUpdated(uint32_t intervalUs, uint16_t latency, uint16_t timeoutMs)
+{
+	this->connParams.intervalUs = intervalUs;
+	this->connParams.latency = latency;
+	this->connParams.timeoutMs = timeoutMs;
+	this->connParams.valid = true;
+	this->connParams.updates++;
 
-	bleKeyboardInstance->hid->manufacturer()->setValue(bleKeyboardInstance->deviceManufacturer);
+	this->hostSlots[this->activeSlot].intervalUs = intervalUs;
 
-	bleKeyboardInstance->hid->pnp(0x02, 0xe502, 0xa111, 0x0210);
-	bleKeyboardInstance->hid->hidInfo(0x00, 0x01);
+	// 发送配额跟随实际连接间隔
+	this->setTxBudget(this->txPerEvent, intervalUs);
+}
 
-	BLESecurity *pSecurity = new BLESecurity();
+void Hid2Ble::onConnParamsRejected(void)
+{
+	this->connParams.rejected++;
+}
 
-	pSecurity->setAuthenticationMode(ESP_LE_AUTH_BOND);
+/**
+ * 主机认证完成 (协议栈任务中调用)：当前槽位为空时，已绑定在其他槽位的主机切回其槽位，
+ * 新主机绑定到当前槽位 (均由 loop 写入 NVS)
+ * @return false 表示该主机属于其他槽位，调用方应断开连接
+ */
+bool Hid2Ble::onHostAuthenticated(const uint8_t *addr, uint8_t addrType)
+{
+	Hid2BleHostSlot *slot = &this->hostSlots[this->activeSlot];
 
-	bleKeyboardInstance->hid->reportMap((uint8_t *)_hidReportDescriptor, sizeof(_hidReportDescriptor));
-	bleKeyboardInstance->hid->startServices();
-	bleKeyboardInstance->hid->setBatteryLevel(bleKeyboardInstance->batteryLevel);
-	bleKeyboardInstance->onStarted(pServer);
+	if (!slot->valid)
+	{
+		for (uint8_t i = 0; i < HID2BLE_HOST_SLOTS; i++)
+		{
+			if (this->hostSlots[i].valid && memcmp(this->hostSlots[i].addr, addr, sizeof(slot->addr)) == 0)
+			{
+				// 同一主机不重复占用两个槽位
+				this->activeSlot = i;
+				this->hostDirty = true;
+				this->hostAccepted = true;
+				return true;
+			}
+		}
+		memcpy(slot->addr, addr, sizeof(slot->addr));
+		slot->addrType = addrType;
+		slot->valid = true;
+		this->hostDirty = true;
+	}
+	else if (memcmp(slot->addr, addr, sizeof(slot->addr)) != 0)
+	{
+		this->rejectedHosts++;
+		return false;
+	}
+	this->hostAccepted = true;
+	return true;
+}
 
-	BLEAdvertising *pAdvertising = pServer->getAdvertising();
-	pAdvertising->setAppearance(HID_KEYBOARD);
-	pAdvertising->addServiceUUID(bleKeyboardInstance->hid->hidService()->getUUID());
-	pAdvertising->addServiceUUID(bleKeyboardInstance->hid->deviceInfo()->getUUID());
-	pAdvertising->addServiceUUID(bleKeyboardInstance->hid->batteryService()->getUUID());
+// =================================================================================
+// 断线重连
+// =================================================================================
 
-	pAdvertising->start();
+/**
+ * 从 NVS 读取所有主机槽位 (键名 "addr0"/"type0" ...) 与当前槽位 ("active")
+ */
+void Hid2Ble::loadHost(void)
+{
+	Preferences prefs;
+	char key[8];
 
-	vTaskDelay(portMAX_DELAY); //delay(portMAX_DELAY);
+	prefs.begin(HID2BLE_HOST_NAMESPACE, true);
+	for (uint8_t i = 0; i < HID2BLE_HOST_SLOTS; i++)
+	{
+		snprintf(key, sizeof(key), "addr%d", i);
+		if (prefs.getBytesLength(key) == sizeof(this->hostSlots[i].addr))
+		{
+			prefs.getBytes(key, this->hostSlots[i].addr, sizeof(this->hostSlots[i].addr));
+			snprintf(key, sizeof(key), "type%d", i);
+			this->hostSlots[i].addrType = prefs.getUChar(key, 0);
+			this->hostSlots[i].valid = true;
+		}
+	}
+	this->activeSlot = prefs.getUChar("active", 0) % HID2BLE_HOST_SLOTS;
+	prefs.end();
 }
 
-void Hid2Ble::send2Ble(char *keys)
+void Hid2Ble::saveHost(uint8_t slot)
 {
+	Preferences prefs;
+	char key[8];
+
+	prefs.begin(HID2BLE_HOST_NAMESPACE, false);
+	snprintf(key, sizeof(key), "addr%d", slot);
+	if (this->hostSlots[slot].valid)
+	{
+		prefs.putBytes(key, this->hostSlots[slot].addr, sizeof(this->hostSlots[slot].addr));
+		snprintf(key, sizeof(key), "type%d", slot);
+		prefs.putUChar(key, this->hostSlots[slot].addrType);
+	}
+	else
+	{
+		prefs.remove(key);
+		snprintf(key, sizeof(key), "type%d", slot);
+		prefs.remove(key);
+	}
+	prefs.putUChar("active", this->activeSlot);
+	prefs.end();
+}
+
+void Hid2Ble::forgetHost(void)
+{
+	this->hostSlots[this->activeSlot].valid = false;
+	this->saveHost(this->activeSlot);
 	if (this->isConnected())
 	{
-		this->inputKeyboard->setValue((uint8_t *)keys, 8);
-		this->inputKeyboard->notify();
+		this->disconnectHost();
 	}
 }
-void Hid2Ble::sendMedia2Ble(char *keys)
+
+void Hid2Ble::selectHostSlot(uint8_t slot)
 {
+	if (slot >= HID2BLE_HOST_SLOTS || slot == this->activeSlot)
+	{
+		return;
+	}
+	this->activeSlot = slot;
+	this->saveHost(slot);
+
 	if (this->isConnected())
 	{
-		this->inputMediaKeys->setValue((uint8_t *)keys, 2);
-		this->inputMediaKeys->notify();
+		// 断开后由 updateReconnect 对新槽位主机定向广播
+		this->disconnectHost();
+	}
+	else if (this->started)
+	{
+		// 正在广播：立即从定向广播重新开始，切换耗时从此刻计
+		this->disconnectTime = millis();
+		this->startAdvertising(this->hostSlots[slot].valid ? HID2BLE_ADV_DIRECTED : HID2BLE_ADV_FAST);
+	}
+}
+
+uint8_t Hid2Ble::getActiveHostSlot(void)
+{
+	return this->activeSlot;
+}
+
+void Hid2Ble::getHostSlot(uint8_t slot, Hid2BleHostSlot *info)
+{
+	*info = this->hostSlots[slot % HID2BLE_HOST_SLOTS];
+}
+
+uint32_t Hid2Ble::getRejectedHosts(void)
+{
+	return this->rejectedHosts;
+}
+
+/**
+ * 开始指定阶段的广播，记录阶段与起始时间
+ */
+void Hid2Ble::startAdvertising(uint8_t phase)
+{
+	this->stopAdvertising();
+	this->advertiseStart(phase);
+	this->advPhase = phase;
+	this->advPhaseStart = millis();
+}
+
+void Hid2Ble::stopAdvertising(void)
+{
+	if (this->advPhase != HID2BLE_ADV_NONE)
+	{
+		this->advertiseStop(this->advPhase);
+	}
+	this->advPhase = HID2BLE_ADV_NONE;
+}
+
+void Hid2Ble::updateReconnect(void)
+{
+	bool connected = this->isConnected();
+
+	if (!this->started)
+	{
+		return; // 协议栈尚未初始化
+	}
+
+	if (this->hostDirty)
+	{
+		this->hostDirty = false;
+		this->saveHost(this->activeSlot);
+	}
+
+	// 当前槽位主机认证完成：统计重连 (切换) 耗时。被拒绝的主机不会走到这里
+	if (this->hostAccepted)
+	{
+		Hid2BleHostSlot *slot = &this->hostSlots[this->activeSlot];
+
+		this->hostAccepted = false;
+		slot->connects++;
+		if (this->disconnectTime != 0)
+		{
+			uint32_t elapsed = millis() - this->disconnectTime;
+			this->reconnectStats.count++;
+			this->reconnectStats.lastMs = elapsed;
+			if (this->reconnectStats.minMs == 0 || elapsed < this->reconnectStats.minMs)
+			{
+				this->reconnectStats.minMs = elapsed;
+			}
+			if (elapsed > this->reconnectStats.maxMs)
+			{
+				this->reconnectStats.maxMs = elapsed;
+			}
+			slot->lastReconnectMs = elapsed;
+			this->disconnectTime = 0;
+		}
+	}
+
+	// 连接建立：广播已由控制器停止
+	if (connected && !this->wasConnected)
+	{
+		this->reconnectStats.lastPhase = this->advPhase;
+		this->advPhase = HID2BLE_ADV_NONE;
+	}
+	// 连接断开：优先对缓存的主机定向广播
+	else if (!connected && this->wasConnected)
+	{
+		// 被拒绝的主机断开时保留原起点，耗时统计到当前槽位主机连上为止
+		if (this->disconnectTime == 0)
+		{
+			this->disconnectTime = millis();
+		}
+		this->startAdvertising(this->hostSlots[this->activeSlot].valid ? HID2BLE_ADV_DIRECTED : HID2BLE_ADV_FAST);
 	}
+	// 广播阶段超时：定向 -> 快速 -> 慢速
+	else if (!connected)
+	{
+		uint32_t elapsed = millis() - this->advPhaseStart;
+
+		if (this->advPhase == HID2BLE_ADV_DIRECTED && elapsed >= HID2BLE_ADV_DIRECTED_MS)
+		{
+			this->startAdvertising(HID2BLE_ADV_FAST);
+		}
+		else if (this->advPhase == HID2BLE_ADV_FAST && elapsed >= HID2BLE_ADV_FAST_MS)
+		{
+			this->startAdvertising(HID2BLE_ADV_SLOW);
+		}
+	}
+
+	this->wasConnected = connected;
+}
+
+void Hid2Ble::getReconnectStats(Hid2BleReconnectStats *stats)
+{
+	*stats = this->reconnectStats;
 }
 
-// Additional function for Brightness control
+// =================================================================================
+// 报文发送队列
+// =================================================================================
+
+/**
+ * 将报文转换为按键集合 (位图)，便于比较
+ * 键盘报文: 修饰键 + 键码数组；其余报文本身即为位图
+ */
+static void reportToSet(uint8_t id, const uint8_t *data, uint8_t len, uint8_t *set)
+{
+	memset(set, 0, 33);
+	if (id == KEYBOARD_ID)
+	{
+		set[32] = data[0];
+		for (int i = 2; i < 8; i++)
+		{
+			if (data[i])
+			{
+				set[data[i] >> 3] |= 1 << (data[i] & 7);
+			}
+		}
+	}
+	else
+	{
+		memcpy(set, data, len);
+	}
+}
+
+/**
+ * 判断新报文能否取代队列中尚未发送的报文
+ * 只有待发送报文相对上一个报文所做的每个改变 (按下或释放) 在新报文中依然成立时才可合并，
+ * 否则短按或快速连按会被吞掉
+ */
+static bool canCoalesce(uint8_t id, uint8_t len, const uint8_t *prev, const uint8_t *pending, const uint8_t *next)
+{
+	uint8_t p[33], q[33], n[33];
+
+	reportToSet(id, prev, len, p);
+	reportToSet(id, pending, len, q);
+	reportToSet(id, next, len, n);
+	for (int i = 0; i < 33; i++)
+	{
+		if ((p[i] ^ q[i]) & (q[i] ^ n[i]))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * 报文入队 (loop 调用)
+ * 队尾是同一 Report ID 的待发送报文且可被取代时直接覆盖，否则追加；
+ * 队列满时覆盖最后一个同 ID 报文，队列中没有同 ID 报文才丢弃 (返回 false)
+ */
+bool Hid2Ble::enqueue(uint8_t id, const uint8_t *data, uint8_t len)
+{
+	bool queued = true;
+
+	if (len > HID2BLE_REPORT_MAX || id == 0 || id > 3)
+	{
+		return false;
+	}
+
+	portENTER_CRITICAL(&this->txMux);
+	Hid2BleReport *tail = NULL;
+	const uint8_t *prev = this->lastTaken[id - 1];
+
+	if (this->txCount > 0)
+	{
+		tail = &this->txQueue[(this->txHead + this->txCount - 1) % HID2BLE_QUEUE_LEN];
+		// 队尾之前同 ID 的报文才是队尾报文的"上一个"
+		for (int i = this->txCount - 2; i >= 0; i--)
+		{
+			Hid2BleReport *r = &this->txQueue[(this->txHead + i) % HID2BLE_QUEUE_LEN];
+			if (r->id == id)
+			{
+				prev = r->data;
+				break;
+			}
+		}
+	}
+
+	if (tail && tail->id == id && canCoalesce(id, len, prev, tail->data, data))
+	{
+		memcpy(tail->data, data, len); // 保留原入队时间，延迟统计不被合并掩盖
+		this->txStats.coalesced++;
+	}
+	else if (this->txCount >= HID2BLE_QUEUE_LEN)
+	{
+		// 队列满：以最新状态覆盖队列中最后一个同 ID 报文，中间状态丢失但按键不会卡住
+		Hid2BleReport *last = NULL;
+		for (int i = this->txCount - 1; i >= 0 && !last; i--)
+		{
+			Hid2BleReport *r = &this->txQueue[(this->txHead + i) % HID2BLE_QUEUE_LEN];
+			if (r->id == id)
+			{
+				last = r;
+			}
+		}
+		if (last)
+		{
+			memcpy(last->data, data, len);
+		}
+		else
+		{
+			queued = false;
+		}
+		this->txStats.dropped++;
+	}
+	else
+	{
+		Hid2BleReport *r = &this->txQueue[(this->txHead + this->txCount) % HID2BLE_QUEUE_LEN];
+		r->id = id;
+		r->len = len;
+		memcpy(r->data, data, len);
+		r->enqueueTime = esp_timer_get_time();
+		this->txCount++;
+		if (this->txCount > this->txStats.maxDepth)
+		{
+			this->txStats.maxDepth = this->txCount;
+		}
+	}
+	if (queued)
+	{
+		this->txStats.queued++;
+	}
+	portEXIT_CRITICAL(&this->txMux);
+
+	if (queued && this->txTaskHandle)
+	{
+		xTaskNotifyGive(this->txTaskHandle);
+	}
+	return queued;
+}
+
+/**
+ * 报文出队 (发送任务调用)
+ * 文本输入期间出队的键盘报文同步到打包器的主机状态
+ */
+bool Hid2Ble::dequeue(Hid2BleReport *report)
+{
+	bool ok = false;
+
+	portENTER_CRITICAL(&this->txMux);
+	if (this->txCount > 0)
+	{
+		*report = this->txQueue[this->txHead];
+		memcpy(this->lastTaken[report->id - 1], report->data, report->len);
+		if (this->typing && report->id == KEYBOARD_ID)
+		{
+			// 文本输入期间插入的键盘报文改变了主机状态，打包器据此判断下一组是否需要先释放
+			memcpy(this->typer.last, report->data, HID_TYPER_REPORT_LEN);
+			this->typer.held = false;
+			for (int i = 0; i < HID_TYPER_REPORT_LEN; i++)
+			{
+				this->typer.held |= report->data[i] != 0;
+			}
+		}
+		this->txHead = (this->txHead + 1) % HID2BLE_QUEUE_LEN;
+		this->txCount--;
+		ok = true;
+	}
+	portEXIT_CRITICAL(&this->txMux);
+
+	return ok;
+}
+
+/**
+ * 等待发送配额 (令牌桶)：每个连接间隔补充 txPerEvent 个，避免塞满控制器发送缓冲
+ */
+void Hid2Ble::waitTxToken(void)
+{
+	for (;;)
+	{
+		int64_t now = esp_timer_get_time();
+		uint32_t refill = (now - this->txLastRefill) / this->txIntervalUs;
+
+		if (refill > 0)
+		{
+			uint32_t tokens = this->txTokens + refill * this->txPerEvent;
+			this->txTokens = tokens > this->txPerEvent ? this->txPerEvent : tokens;
+			this->txLastRefill = now;
+		}
+		if (this->txTokens > 0)
+		{
+			this->txTokens--;
+			return;
+		}
+		portENTER_CRITICAL(&this->txMux);
+		this->txStats.throttled++;
+		portEXIT_CRITICAL(&this->txMux);
+		vTaskDelay(1);
+	}
+}
+
+/**
+ * 生成下一个文本报文 (发送任务调用)
+ * 文本结束 (最后的释放报文已发出) 或连接断开时结束输入并统计速度
+ */
+bool Hid2Ble::nextTyped(Hid2BleReport *report)
+{
+	bool more;
+	int64_t now;
+
+	if (!this->typing)
+	{
+		return false;
+	}
+
+	now = esp_timer_get_time();
+	if (!this->isConnected())
+	{
+		this->typeStats.aborted++;
+		this->typing = false;
+		return false;
+	}
+
+	portENTER_CRITICAL(&this->txMux);
+	more = hidTyperNext(&this->typer, report->data);
+	if (more)
+	{
+		// 与 dequeue 一致，记录最近发出的键盘报文，之后入队的报文据此判断能否合并
+		memcpy(this->lastTaken[KEYBOARD_ID - 1], report->data, HID_TYPER_REPORT_LEN);
+	}
+	portEXIT_CRITICAL(&this->txMux);
+
+	if (!more)
+	{
+		uint32_t elapsed = now - this->typeStart;
+
+		this->typeStats.chars += this->typer.chars;
+		this->typeStats.skipped += this->typer.skipped;
+		this->typeStats.reports += this->typeReports;
+		if (this->typeStop)
+		{
+			this->typeStats.aborted++;
+		}
+		else
+		{
+			this->typeStats.runs++;
+			this->typeStats.charsPerSec = elapsed ? (uint64_t)this->typer.chars * 1000000 / elapsed : 0;
+			if (this->typeStats.charsPerSec > this->typeStats.peakCharsPerSec)
+			{
+				this->typeStats.peakCharsPerSec = this->typeStats.charsPerSec;
+			}
+		}
+		this->typing = false;
+		return false;
+	}
+
+	if (this->typeReports++ == 0)
+	{
+		this->typeStart = now;
+	}
+	report->id = KEYBOARD_ID;
+	report->len = HID_TYPER_REPORT_LEN;
+	report->enqueueTime = now;
+	return true;
+}
+
+bool Hid2Ble::typeString(const char *text, uint8_t maxPerReport)
+{
+	if (!this->isConnected() || this->typing)
+	{
+		return false;
+	}
+
+	this->typeText = text;
+	this->typeReports = 0;
+	this->typeStop = false;
+
+	portENTER_CRITICAL(&this->txMux);
+	hidTyperBegin(&this->typer, this->typeText.c_str(), maxPerReport);
+	// 主机当前按住的键视为上一组，第一个字符与之冲突时先释放
+	memcpy(this->typer.last, this->lastTaken[KEYBOARD_ID - 1], HID_TYPER_REPORT_LEN);
+	for (int i = 0; i < HID_TYPER_REPORT_LEN; i++)
+	{
+		this->typer.held |= this->typer.last[i] != 0;
+	}
+	this->typing = true;
+	portEXIT_CRITICAL(&this->txMux);
+
+	if (this->txTaskHandle)
+	{
+		xTaskNotifyGive(this->txTaskHandle);
+	}
+	return true;
+}
+
+bool Hid2Ble::isTyping(void)
+{
+	return this->typing;
+}
+
+void Hid2Ble::stopTyping(void)
+{
+	if (!this->typing)
+	{
+		return;
+	}
+
+	// 跳到文本末尾：发送任务输出释放报文后结束
+	portENTER_CRITICAL(&this->txMux);
+	this->typer.p = (const uint8_t *)this->typeText.c_str() + this->typeText.size();
+	this->typeStop = true;
+	portEXIT_CRITICAL(&this->txMux);
+
+	if (this->txTaskHandle)
+	{
+		xTaskNotifyGive(this->txTaskHandle);
+	}
+}
+
+void Hid2Ble::getTypeStats(Hid2BleTypeStats *stats)
+{
+	*stats = this->typeStats;
+}
+
+/**
+ * 发送任务：取出报文，按配额逐个通知并统计延迟
+ * 队列中的实时报文优先，队列空闲时再生成文本报文
+ */
+void Hid2Ble::taskSender(void *pvParameter)
+{
+	Hid2Ble *self = (Hid2Ble *)pvParameter;
+	Hid2BleReport report;
+
+	for (;;)
+	{
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+		while (self->dequeue(&report) || self->nextTyped(&report))
+		{
+			if (!self->isConnected())
+			{
+				portENTER_CRITICAL(&self->txMux);
+				self->txStats.dropped++;
+				portEXIT_CRITICAL(&self->txMux);
+				continue;
+			}
+			self->waitTxToken();
+			self->notifyReport(&report);
+
+			// 统计与 enqueue/getTxStats 共用 txMux，快照保持一致
+			uint32_t latency = esp_timer_get_time() - report.enqueueTime;
+			portENTER_CRITICAL(&self->txMux);
+			self->txStats.sent++;
+			self->txLatencySum += latency;
+			if (latency > self->txStats.latencyMaxUs)
+			{
+				self->txStats.latencyMaxUs = latency;
+			}
+			portEXIT_CRITICAL(&self->txMux);
+		}
+	}
+}
+
+void Hid2Ble::setTxBudget(uint8_t perEvent, uint32_t intervalUs)
+{
+	this->txPerEvent = perEvent > 0 ? perEvent : 1;
+	this->txIntervalUs = intervalUs > 0 ? intervalUs : HID2BLE_TX_INTERVAL_US;
+}
+
+uint8_t Hid2Ble::txQueueFree(void)
+{
+	uint8_t count;
+
+	portENTER_CRITICAL(&this->txMux);
+	count = this->txCount;
+	portEXIT_CRITICAL(&this->txMux);
+	return HID2BLE_QUEUE_LEN - count;
+}
+
+void Hid2Ble::getTxStats(Hid2BleStats *stats)
+{
+	portENTER_CRITICAL(&this->txMux);
+	*stats = this->txStats;
+	stats->depth = this->txCount;
+	stats->latencyAvgUs = this->txStats.sent ? this->txLatencySum / this->txStats.sent : 0;
+	portEXIT_CRITICAL(&this->txMux);
+}
 
-// ?
+#endif
@@ -3,20 +3,250 @@
 #include "sdkconfig.h"
 #if defined(CONFIG_BT_ENABLED)
 
+#include <string>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "BleConnectionStatus.h"
+#include "HidAscii.h"
+
+// 传输层选择：定义 HID2BLE_USE_NIMBLE 时使用 NimBLE 主机 (内存/Flash 占用更小)，否则使用 Bluedroid
+#if defined(HID2BLE_USE_NIMBLE)
+#include <NimBLEDevice.h>
+#include <NimBLEHIDDevice.h>
+typedef NimBLEServer Hid2BleServer;
+typedef NimBLEHIDDevice Hid2BleHidDevice;
+typedef NimBLECharacteristic Hid2BleCharacteristic;
+typedef NimBLECharacteristicCallbacks Hid2BleCharacteristicCallbacks;
+typedef NimBLEAdvertising Hid2BleAdvertising;
+#else
+#include "esp_gap_ble_api.h"
 #include "BLEHIDDevice.h"
 #include "BLECharacteristic.h"
+typedef BLEServer Hid2BleServer;
+typedef BLEHIDDevice Hid2BleHidDevice;
+typedef BLECharacteristic Hid2BleCharacteristic;
+typedef BLECharacteristicCallbacks Hid2BleCharacteristicCallbacks;
+typedef BLEAdvertising Hid2BleAdvertising;
+#endif
+
+// NKRO 位图报文长度：用法 0x00 ~ 0xE7，每键 1 位
+#define HID2BLE_NKRO_LEN 29
+
+// 报文发送队列
+#define HID2BLE_QUEUE_LEN 16         // 队列长度
+#define HID2BLE_REPORT_MAX HID2BLE_NKRO_LEN // 最长报文
+#define HID2BLE_TX_PER_EVENT 4       // 每个连接间隔最多发出的通知数
+#define HID2BLE_TX_INTERVAL_US 7500  // 默认连接间隔 (us)
+#define HID2BLE_TX_TASK_STACK 4096
+#define HID2BLE_TX_TASK_PRIORITY 6
+
+// 连接参数 (间隔单位 1.25ms，超时单位 10ms)
+// 活跃：7.5 ~ 15ms 间隔，无从机延迟，按键延迟最低
+#define HID2BLE_ACTIVE_MIN_INT 6
+#define HID2BLE_ACTIVE_MAX_INT 12
+#define HID2BLE_ACTIVE_LATENCY 0
+#define HID2BLE_ACTIVE_TIMEOUT 200
+// 空闲：15 ~ 30ms 间隔，从机延迟 20 个连接事件，降低射频占空比
+#define HID2BLE_IDLE_MIN_INT 12
+#define HID2BLE_IDLE_MAX_INT 24
+#define HID2BLE_IDLE_LATENCY 20
+#define HID2BLE_IDLE_TIMEOUT 400
+// 无按键活动多久后切换到空闲参数 (ms)
+#define HID2BLE_IDLE_TIMEOUT_MS 5000
+
+// 断线重连广播 (间隔单位 0.625ms)
+#define HID2BLE_ADV_DIRECTED_MS 1280   // 高占空比定向广播时长 (协议上限 1.28s)
+#define HID2BLE_ADV_FAST_MS 30000      // 快速无定向广播时长
+#define HID2BLE_ADV_FAST_MIN_INT 32    // 20ms
+#define HID2BLE_ADV_FAST_MAX_INT 48    // 30ms
+#define HID2BLE_ADV_SLOW_MIN_INT 1600  // 1s
+#define HID2BLE_ADV_SLOW_MAX_INT 4000  // 2.5s
+#define HID2BLE_HOST_NAMESPACE "BLE_HOST" // 已绑定主机身份缓存 (NVS 命名空间)
+#define HID2BLE_HOST_SLOTS 3           // 主机槽位数
+
+/**
+ * 广播阶段
+ */
+enum Hid2BleAdvPhase
+{
+  HID2BLE_ADV_NONE = 0, // 未广播 (已连接)
+  HID2BLE_ADV_DIRECTED, // 高占空比定向广播 (仅对缓存的主机)
+  HID2BLE_ADV_FAST,     // 快速无定向广播
+  HID2BLE_ADV_SLOW      // 慢速无定向广播 (持续)
+};
+
+/**
+ * 重连统计
+ */
+struct Hid2BleReconnectStats
+{
+  uint32_t count;     // 重连成功次数
+  uint32_t lastMs;    // 最近一次断开到重连的耗时 (ms)
+  uint32_t minMs;     // 最短耗时 (ms)
+  uint32_t maxMs;     // 最长耗时 (ms)
+  uint8_t lastPhase;  // 最近一次重连时所处的广播阶段 (Hid2BleAdvPhase)
+};
+
+/**
+ * 主机槽位：每个槽位绑定一台主机，只接受当前槽位主机的连接
+ */
+struct Hid2BleHostSlot
+{
+  bool valid;                  // 是否已绑定主机
+  uint8_t addr[6];             // 主机身份地址 (高字节在前)
+  uint8_t addrType;            // 地址类型 (0 = 公共地址, 1 = 随机地址)
+  // 链路统计 (本次开机以来)
+  uint32_t connects;           // 连接成功次数
+  uint32_t lastReconnectMs;    // 最近一次断开/切换到连接的耗时 (ms)
+  uint32_t intervalUs;         // 最近协商的连接间隔 (us)
+};
+
+/**
+ * 连接参数档位
+ */
+enum Hid2BleConnProfile
+{
+  HID2BLE_PROFILE_NONE = 0, // 未请求 (未连接)
+  HID2BLE_PROFILE_ACTIVE,
+  HID2BLE_PROFILE_IDLE
+};
+
+/**
+ * 协商后的连接参数
+ */
+struct Hid2BleConnParams
+{
+  bool valid;          // 是否已收到主机确认的参数
+  uint32_t intervalUs; // 连接间隔 (us)
+  uint16_t latency;    // 从机延迟 (连接事件数)
+  uint16_t timeoutMs;  // 监督超时 (ms)
+  uint8_t profile;     // 最近请求的档位 (Hid2BleConnProfile)
+  uint32_t updates;    // 主机确认的参数更新次数
+  uint32_t rejected;   // 参数更新失败次数
+};
+
+/**
+ * 待发送报文
+ */
+struct Hid2BleReport
+{
+  uint8_t id;                         // Report ID
+  uint8_t len;                        // 报文长度
+  uint8_t data[HID2BLE_REPORT_MAX];   // 报文内容
+  int64_t enqueueTime;                // 入队时间 (us)
+};
+
+/**
+ * 发送队列统计
+ */
+struct Hid2BleStats
+{
+  uint8_t depth;         // 当前队列深度
+  uint8_t maxDepth;      // 历史最大深度
+  uint32_t queued;       // 入队报文数
+  uint32_t sent;         // 已通知的报文数
+  uint32_t coalesced;    // 被新报文合并取代的报文数
+  uint32_t dropped;      // 队列满被覆盖/丢弃或已断开而丢弃的报文数
+  uint32_t throttled;    // 因发送配额用尽而等待的次数
+  uint32_t latencyAvgUs; // 入队到通知的平均延迟 (us)
+  uint32_t latencyMaxUs; // 入队到通知的最大延迟 (us)
+};
+
+/**
+ * 文本输入统计 (typeString)
+ */
+struct Hid2BleTypeStats
+{
+  uint32_t runs;            // 完成的文本数
+  uint32_t aborted;         // 被中止 (stopTyping / 断开) 的文本数
+  uint32_t chars;           // 已输入的字符数
+  uint32_t skipped;         // 跳过的字符数 (不可输入的 ASCII 与非 ASCII 字符)
+  uint32_t reports;         // 文本输入发出的报文数
+  uint32_t charsPerSec;     // 最近一段文本的输入速度 (字符/秒，第一个报文到最后一个报文)
+  uint32_t peakCharsPerSec; // 历史最高输入速度 (字符/秒)
+};
 
 class Hid2Ble
 {
+  friend class BleConnectionStatus;
+
 private:
   BleConnectionStatus *connectionStatus;
-  BLEHIDDevice *hid;
-  BLECharacteristic *inputKeyboard;
-  BLECharacteristic *outputKeyboard;
-  BLECharacteristic *inputMediaKeys;
-  BLECharacteristicCallbacks *callBack;
+  Hid2BleHidDevice *hid;
+  Hid2BleCharacteristic *inputKeyboard;
+  Hid2BleCharacteristic *outputKeyboard;
+  Hid2BleCharacteristic *inputMediaKeys;
+  Hid2BleCharacteristic *inputNkro;
+  Hid2BleCharacteristicCallbacks *callBack;
+  Hid2BleServer *server;
+  Hid2BleAdvertising *advertising;
+  volatile bool started;                // 协议栈与服务已初始化
+
+  // --- 报文发送队列 (loop 生产，发送任务消费) ---
+  Hid2BleReport txQueue[HID2BLE_QUEUE_LEN];
+  uint8_t txHead;                     // 下一个出队位置
+  uint8_t txCount;                    // 队列中的报文数
+  uint8_t lastTaken[3][HID2BLE_REPORT_MAX]; // 各 Report ID 最近一次出队的报文
+  portMUX_TYPE txMux;
+  TaskHandle_t txTaskHandle;
+  Hid2BleStats txStats;
+  uint64_t txLatencySum;
+  uint8_t txPerEvent;                 // 每个连接间隔的通知配额
+  uint32_t txIntervalUs;              // 配额补充周期
+  uint8_t txTokens;
+  int64_t txLastRefill;
+
+  static void taskSender(void *pvParameter);
+  bool enqueue(uint8_t id, const uint8_t *data, uint8_t len);
+  bool dequeue(Hid2BleReport *report);
+  void waitTxToken(void);
+
+  // --- 文本输入 (loop 启动，发送任务在队列空闲时逐个报文生成) ---
+  std::string typeText;
+  HidTyper typer;
+  volatile bool typing;
+  volatile bool typeStop;             // stopTyping 已请求中止
+  int64_t typeStart;                  // 第一个报文的发送时间 (us)
+  uint32_t typeReports;
+  Hid2BleTypeStats typeStats;
+  bool nextTyped(Hid2BleReport *report);
+
+  // --- 连接参数 ---
+  Hid2BleConnParams connParams;
+  uint32_t lastActivity;
+  static Hid2Ble *instance;             // 协议栈回调为静态函数，通过此指针回到对象
+  void requestConnParams(uint8_t profile);
+  void onConnParamsUpdated(uint32_t intervalUs, uint16_t latency, uint16_t timeoutMs);
+  void onConnParamsRejected(void);
+
+  // --- 断线重连与主机槽位 ---
+  Hid2BleHostSlot hostSlots[HID2BLE_HOST_SLOTS];
+  uint8_t activeSlot;                   // 当前槽位
+  volatile bool hostDirty;              // 当前槽位已绑定新主机或切回已有槽位，待写入 NVS
+  volatile bool hostAccepted;           // 当前槽位主机认证完成，待统计
+  uint32_t rejectedHosts;               // 因不属于当前槽位而断开的连接数
+  bool wasConnected;
+  uint8_t advPhase;
+  uint32_t advPhaseStart;
+  uint32_t disconnectTime;
+  Hid2BleReconnectStats reconnectStats;
+  void loadHost(void);
+  void saveHost(uint8_t slot);
+  void startAdvertising(uint8_t phase);
+  void stopAdvertising(void);
+  bool onHostAuthenticated(const uint8_t *addr, uint8_t addrType);
+
+  // --- 传输层相关 (Hid2BleBluedroid.cpp / Hid2BleNimBLE.cpp 各自实现) ---
+  bool notifyReport(const Hid2BleReport *report);
+  void sendConnParams(uint16_t minInt, uint16_t maxInt, uint16_t latency, uint16_t timeout);
+  void refreshConnParams(void);
+  void disconnectHost(void);
+  void advertiseStart(uint8_t phase);
+  void advertiseStop(uint8_t phase);
+#if !defined(HID2BLE_USE_NIMBLE)
   static void taskServer(void *pvParameter);
+  static void gapHandler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t *param);
+#endif
 
 public:
   /**
@@ -25,15 +255,96 @@ public:
   Hid2Ble(std::string deviceName = "ESP32 BLE Keyboard", std::string deviceManufacturer = "Espressif", uint8_t batteryLevel = 100);
   void begin(void);
   void end(void);
-  void send2Ble(char *keys);
+  /**
+   * 发送 Boot 键盘报文 (8 字节)
+   * @return false 表示未连接或报文被丢弃，调用方应在下次重发完整状态
+   */
+  bool send2Ble(char *keys);
   void sendMedia2Ble(char *keys);
+  /**
+   * 发送 NKRO 位图报文 (Report ID 3, HID2BLE_NKRO_LEN 字节)
+   * @return 同 send2Ble
+   */
+  bool sendNkro2Ble(const uint8_t *bitmap);
   bool isConnected(void);
   /**
    * 设置电池电量
   */
   void setBatteryLevel(uint8_t level);
 
-  void setCallBack(BLECharacteristicCallbacks *callBack);
+  void setCallBack(Hid2BleCharacteristicCallbacks *callBack);
+  /**
+   * 设置发送配额：每个连接间隔最多发出 perEvent 个通知
+   */
+  void setTxBudget(uint8_t perEvent, uint32_t intervalUs);
+  /**
+   * 按键活动通知：切换到活跃连接参数，空闲超时后由 updateConnProfile 切回空闲参数
+   */
+  void onActivity(void);
+  /**
+   * 周期调用 (loop)：根据活动情况维护连接参数档位
+   */
+  void updateConnProfile(void);
+  /**
+   * 周期调用 (loop)：断开后依次进行定向 -> 快速 -> 慢速广播，并统计重连耗时
+   */
+  void updateReconnect(void);
+  /**
+   * 获取重连统计
+   */
+  void getReconnectStats(Hid2BleReconnectStats *stats);
+  /**
+   * 清除当前槽位的主机 (下次断开后直接无定向广播，新主机配对后绑定到该槽位)
+   */
+  void forgetHost(void);
+  /**
+   * 切换当前主机槽位：断开当前主机并立即对新槽位主机定向广播
+   */
+  void selectHostSlot(uint8_t slot);
+  /**
+   * 当前主机槽位
+   */
+  uint8_t getActiveHostSlot(void);
+  /**
+   * 获取槽位信息与链路统计
+   */
+  void getHostSlot(uint8_t slot, Hid2BleHostSlot *info);
+  /**
+   * 因不属于当前槽位而被拒绝的连接数
+   */
+  uint32_t getRejectedHosts(void);
+  /**
+   * 获取协商后的连接参数
+   */
+  void getConnParams(Hid2BleConnParams *params);
+  /**
+   * 发送队列剩余空间 (宏等批量发送方据此控制节奏)
+   */
+  uint8_t txQueueFree(void);
+  /**
+   * 获取发送队列统计
+   */
+  void getTxStats(Hid2BleStats *stats);
+  /**
+   * 输入一段文本 (美式布局 ASCII，UTF-8 多字节字符跳过)，不阻塞：
+   * 发送任务在报文队列空闲时按 HidAscii.h 的打包规则逐个生成报文，实时按键报文优先。
+   * 输入期间键盘报文由文本占用，按住的按键会被暂时释放
+   * maxPerReport：每个报文最多同时按下的键数，1 表示逐字符按下 (兼容会重排同一报文内按键的主机)
+   * 未连接或正在输入另一段文本时返回 false
+   */
+  bool typeString(const char *text, uint8_t maxPerReport = 6);
+  /**
+   * 是否正在输入文本
+   */
+  bool isTyping(void);
+  /**
+   * 中止文本输入 (释放已按下的键后结束)
+   */
+  void stopTyping(void);
+  /**
+   * 获取文本输入统计
+   */
+  void getTypeStats(Hid2BleTypeStats *stats);
   /**
    * 电池电量
    */ 
@@ -48,7 +359,7 @@ public:
   std::string deviceName;
 
 protected:
-  virtual void onStarted(BLEServer *pServer){};
+  virtual void onStarted(Hid2BleServer *pServer){};
 };
 
 #endif
@@ -0,0 +1,208 @@
+/**
+ * Hid2Ble 传输层：Bluedroid (Arduino BLEDevice/BLEHIDDevice)，默认实现
+ */
+#include "sdkconfig.h"
+#include "Hid2Ble.h"
+#if defined(CONFIG_BT_ENABLED) && !defined(HID2BLE_USE_NIMBLE)
+
+#include <BLEDevice.h>
+#include <BLEUtils.h>
+#include <BLEServer.h>
+#include "BLE2902.h"
+#include "BLEHIDDevice.h"
+#include "HIDTypes.h"
+#include <driver/adc.h>
+
+#include "BleConnectionStatus.h"
+#include "HidDescriptor.h"
+#include "BLECharacteristic.h"
+
+void Hid2Ble::begin(void)
+{
+	this->loadHost();
+	xTaskCreate(this->taskServer, "server", 20000, (void *)this, 5, NULL);
+}
+
+void Hid2Ble::setBatteryLevel(uint8_t level)
+{
+	this->batteryLevel = level;
+	this->hid->setBatteryLevel(this->batteryLevel);
+}
+
+void Hid2Ble::taskServer(void *pvParameter)
+{
+	Hid2Ble *bleKeyboardInstance = (Hid2Ble *)pvParameter; //static_cast<BleKeyboard *>(pvParameter);
+	BLEDevice::init(bleKeyboardInstance->deviceName);
+	BLEDevice::setCustomGapHandler(gapHandler);
+	BLEServer *pServer = BLEDevice::createServer();
+	pServer->setCallbacks(bleKeyboardInstance->connectionStatus);
+	bleKeyboardInstance->server = pServer;
+
+	bleKeyboardInstance->hid = new BLEHIDDevice(pServer);
+	bleKeyboardInstance->inputKeyboard = bleKeyboardInstance->hid->inputReport(KEYBOARD_ID); // <-- input REPORTID from report map
+	bleKeyboardInstance->outputKeyboard = bleKeyboardInstance->hid->outputReport(KEYBOARD_ID);
+	bleKeyboardInstance->inputMediaKeys = bleKeyboardInstance->hid->inputReport(MEDIA_KEYS_ID);
+	bleKeyboardInstance->inputNkro = bleKeyboardInstance->hid->inputReport(NKRO_KEYS_ID);
+	bleKeyboardInstance->connectionStatus->inputKeyboard = bleKeyboardInstance->inputKeyboard;
+	bleKeyboardInstance->connectionStatus->outputKeyboard = bleKeyboardInstance->outputKeyboard;
+	bleKeyboardInstance->connectionStatus->inputMediaKeys = bleKeyboardInstance->inputMediaKeys;
+	bleKeyboardInstance->connectionStatus->inputNkro = bleKeyboardInstance->inputNkro;
+
+	bleKeyboardInstance->outputKeyboard->setCallbacks(bleKeyboardInstance->callBack);
+
+	bleKeyboardInstance->hid->manufacturer()->setValue(bleKeyboardInstance->deviceManufacturer);
+
+	bleKeyboardInstance->hid->pnp(0x02, 0xe502, 0xa111, 0x0210);
+	bleKeyboardInstance->hid->hidInfo(0x00, 0x01);
+
+	BLESecurity *pSecurity = new BLESecurity();
+
+	pSecurity->setAuthenticationMode(ESP_LE_AUTH_BOND);
+
+	bleKeyboardInstance->hid->reportMap((uint8_t *)_hidReportDescriptor, sizeof(_hidReportDescriptor));
+	bleKeyboardInstance->hid->startServices();
+	bleKeyboardInstance->hid->setBatteryLevel(bleKeyboardInstance->batteryLevel);
+	bleKeyboardInstance->onStarted(pServer);
+
+	BLEAdvertising *pAdvertising = pServer->getAdvertising();
+	pAdvertising->setAppearance(HID_KEYBOARD);
+	pAdvertising->addServiceUUID(bleKeyboardInstance->hid->hidService()->getUUID());
+	pAdvertising->addServiceUUID(bleKeyboardInstance->hid->deviceInfo()->getUUID());
+	pAdvertising->addServiceUUID(bleKeyboardInstance->hid->batteryService()->getUUID());
+
+	pAdvertising->setMinInterval(HID2BLE_ADV_FAST_MIN_INT);
+	pAdvertising->setMaxInterval(HID2BLE_ADV_FAST_MAX_INT);
+	bleKeyboardInstance->advertising = pAdvertising;
+	bleKeyboardInstance->advPhase = HID2BLE_ADV_FAST;
+	bleKeyboardInstance->advPhaseStart = millis();
+
+	pAdvertising->start();
+
+	xTaskCreate(bleKeyboardInstance->taskSender, "hidTx", HID2BLE_TX_TASK_STACK, (void *)bleKeyboardInstance, HID2BLE_TX_TASK_PRIORITY, &bleKeyboardInstance->txTaskHandle);
+	bleKeyboardInstance->started = true;
+
+	vTaskDelay(portMAX_DELAY); //delay(portMAX_DELAY);
+}
+
+/**
+ * 发出一个报文通知
+ */
+bool Hid2Ble::notifyReport(const Hid2BleReport *report)
+{
+	BLECharacteristic *chr;
+
+	switch (report->id)
+	{
+	case KEYBOARD_ID:
+		chr = this->inputKeyboard;
+		break;
+	case MEDIA_KEYS_ID:
+		chr = this->inputMediaKeys;
+		break;
+	default:
+		chr = this->inputNkro;
+		break;
+	}
+	chr->setValue((uint8_t *)report->data, report->len);
+	chr->notify();
+	return true;
+}
+
+void Hid2Ble::sendConnParams(uint16_t minInt, uint16_t maxInt, uint16_t latency, uint16_t timeout)
+{
+	this->server->updateConnParams(this->connectionStatus->remoteBda, minInt, maxInt, latency, timeout);
+}
+
+/**
+ * Bluedroid 通过 GAP 事件上报参数变化，无需轮询
+ */
+void Hid2Ble::refreshConnParams(void)
+{
+}
+
+void Hid2Ble::disconnectHost(void)
+{
+	esp_ble_gap_disconnect(this->connectionStatus->remoteBda);
+}
+
+/**
+ * 定向广播不带广播数据，直接用 GAP 接口发起；无定向广播沿用 BLEAdvertising 已配置的数据
+ */
+void Hid2Ble::advertiseStart(uint8_t phase)
+{
+	if (phase == HID2BLE_ADV_DIRECTED)
+	{
+		esp_ble_adv_params_t params;
+		memset(&params, 0, sizeof(params));
+		params.adv_type = ADV_TYPE_DIRECT_IND_HIGH;
+		params.own_addr_type = BLE_ADDR_TYPE_PUBLIC;
+		memcpy(params.peer_addr, this->hostSlots[this->activeSlot].addr, sizeof(esp_bd_addr_t));
+		params.peer_addr_type = (esp_ble_addr_type_t)this->hostSlots[this->activeSlot].addrType;
+		params.channel_map = ADV_CHNL_ALL;
+		params.adv_filter_policy = ADV_FILTER_ALLOW_SCAN_ANY_CON_ANY;
+		esp_ble_gap_start_advertising(&params);
+	}
+	else if (phase == HID2BLE_ADV_FAST)
+	{
+		this->advertising->setMinInterval(HID2BLE_ADV_FAST_MIN_INT);
+		this->advertising->setMaxInterval(HID2BLE_ADV_FAST_MAX_INT);
+		this->advertising->start();
+	}
+	else
+	{
+		this->advertising->setMinInterval(HID2BLE_ADV_SLOW_MIN_INT);
+		this->advertising->setMaxInterval(HID2BLE_ADV_SLOW_MAX_INT);
+		this->advertising->start();
+	}
+}
+
+void Hid2Ble::advertiseStop(uint8_t phase)
+{
+	if (phase == HID2BLE_ADV_DIRECTED)
+	{
+		esp_ble_gap_stop_advertising();
+	}
+	else
+	{
+		this->advertising->stop();
+	}
+}
+
+/**
+ * GAP 事件回调 (BLE 协议栈任务中执行)：主机认证与连接参数更新
+ */
+void Hid2Ble::gapHandler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t *param)
+{
+	if (instance == NULL)
+	{
+		return;
+	}
+
+	// 认证完成：只接受当前槽位的主机
+	if (event == ESP_GAP_BLE_AUTH_CMPL_EVT)
+	{
+		if (param->ble_security.auth_cmpl.success &&
+			!instance->onHostAuthenticated(param->ble_security.auth_cmpl.bd_addr, param->ble_security.auth_cmpl.addr_type))
+		{
+			esp_ble_gap_disconnect(param->ble_security.auth_cmpl.bd_addr);
+		}
+		return;
+	}
+
+	if (event != ESP_GAP_BLE_UPDATE_CONN_PARAMS_EVT)
+	{
+		return;
+	}
+
+	if (param->update_conn_params.status != ESP_BT_STATUS_SUCCESS)
+	{
+		instance->onConnParamsRejected();
+		return;
+	}
+
+	instance->onConnParamsUpdated(param->update_conn_params.conn_int * 1250,
+								  param->update_conn_params.latency,
+								  param->update_conn_params.timeout * 10);
+}
+
+#endif
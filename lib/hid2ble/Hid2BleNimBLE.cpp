@@ -0,0 +1,165 @@
+/**
+ * Hid2Ble 传输层：NimBLE (h2zero/NimBLE-Arduino)，定义 HID2BLE_USE_NIMBLE 时启用
+ * 与 Bluedroid 相比占用的 RAM/Flash 更少、启动更快；协议栈在 begin() 中直接初始化，
+ * 不再需要 20 kB 栈的 server 任务
+ */
+#include "sdkconfig.h"
+#include "Hid2Ble.h"
+#if defined(CONFIG_BT_ENABLED) && defined(HID2BLE_USE_NIMBLE)
+
+#include <NimBLEDevice.h>
+#include <NimBLEHIDDevice.h>
+#include "HIDTypes.h"
+
+#include "BleConnectionStatus.h"
+#include "HidDescriptor.h"
+
+void Hid2Ble::begin(void)
+{
+	this->loadHost();
+
+	NimBLEDevice::init(this->deviceName);
+	NimBLEDevice::setSecurityAuth(true, false, false); // 绑定，无 MITM，传统配对
+
+	NimBLEServer *pServer = NimBLEDevice::createServer();
+	pServer->setCallbacks(this->connectionStatus, false);
+	pServer->advertiseOnDisconnect(false); // 断开后的广播由 updateReconnect 负责
+	this->server = pServer;
+
+	this->hid = new NimBLEHIDDevice(pServer);
+	this->inputKeyboard = this->hid->inputReport(KEYBOARD_ID);
+	this->outputKeyboard = this->hid->outputReport(KEYBOARD_ID);
+	this->inputMediaKeys = this->hid->inputReport(MEDIA_KEYS_ID);
+	this->inputNkro = this->hid->inputReport(NKRO_KEYS_ID);
+
+	if (this->callBack)
+	{
+		this->outputKeyboard->setCallbacks(this->callBack);
+	}
+
+	this->hid->manufacturer()->setValue(this->deviceManufacturer);
+
+	this->hid->pnp(0x02, 0xe502, 0xa111, 0x0210);
+	this->hid->hidInfo(0x00, 0x01);
+
+	this->hid->reportMap((uint8_t *)_hidReportDescriptor, sizeof(_hidReportDescriptor));
+	this->hid->startServices();
+	this->hid->setBatteryLevel(this->batteryLevel);
+	this->onStarted(pServer);
+
+	NimBLEAdvertising *pAdvertising = pServer->getAdvertising();
+	pAdvertising->setAppearance(HID_KEYBOARD);
+	pAdvertising->addServiceUUID(this->hid->hidService()->getUUID());
+	this->advertising = pAdvertising;
+
+	xTaskCreate(this->taskSender, "hidTx", HID2BLE_TX_TASK_STACK, (void *)this, HID2BLE_TX_TASK_PRIORITY, &this->txTaskHandle);
+	this->started = true;
+
+	this->startAdvertising(HID2BLE_ADV_FAST);
+}
+
+void Hid2Ble::setBatteryLevel(uint8_t level)
+{
+	this->batteryLevel = level;
+	this->hid->setBatteryLevel(this->batteryLevel);
+}
+
+/**
+ * 发出一个报文通知 (未订阅的主机由 NimBLE 自动跳过)
+ */
+bool Hid2Ble::notifyReport(const Hid2BleReport *report)
+{
+	NimBLECharacteristic *chr;
+
+	switch (report->id)
+	{
+	case KEYBOARD_ID:
+		chr = this->inputKeyboard;
+		break;
+	case MEDIA_KEYS_ID:
+		chr = this->inputMediaKeys;
+		break;
+	default:
+		chr = this->inputNkro;
+		break;
+	}
+	chr->setValue(report->data, report->len);
+	chr->notify();
+	return true;
+}
+
+void Hid2Ble::sendConnParams(uint16_t minInt, uint16_t maxInt, uint16_t latency, uint16_t timeout)
+{
+	this->server->updateConnParams(this->connectionStatus->connId, minInt, maxInt, latency, timeout);
+}
+
+/**
+ * NimBLE-Arduino 不向服务端回调转发参数更新事件，这里直接查询当前连接描述符
+ */
+void Hid2Ble::refreshConnParams(void)
+{
+	struct ble_gap_conn_desc desc;
+
+	if (ble_gap_conn_find(this->connectionStatus->connId, &desc) != 0)
+	{
+		return;
+	}
+
+	uint32_t intervalUs = desc.conn_itvl * 1250;
+	uint16_t timeoutMs = desc.supervision_timeout * 10;
+	if (!this->connParams.valid || intervalUs != this->connParams.intervalUs ||
+		desc.conn_latency != this->connParams.latency || timeoutMs != this->connParams.timeoutMs)
+	{
+		this->onConnParamsUpdated(intervalUs, desc.conn_latency, timeoutMs);
+	}
+}
+
+void Hid2Ble::disconnectHost(void)
+{
+	this->server->disconnect(this->connectionStatus->connId);
+}
+
+/**
+ * NimBLE-Arduino 未开放高占空比标志，定向广播以最短间隔的低占空比方式发出，时长同样为 1.28 s
+ */
+void Hid2Ble::advertiseStart(uint8_t phase)
+{
+	if (phase == HID2BLE_ADV_DIRECTED)
+	{
+		const Hid2BleHostSlot *slot = &this->hostSlots[this->activeSlot];
+		ble_addr_t peer;
+
+		peer.type = slot->addrType;
+		for (int i = 0; i < 6; i++)
+		{
+			peer.val[i] = slot->addr[5 - i]; // 槽位中高字节在前，NimBLE 低字节在前
+		}
+		NimBLEAddress addr(peer);
+
+		this->advertising->setAdvertisementType(BLE_GAP_CONN_MODE_DIR);
+		this->advertising->setMinInterval(HID2BLE_ADV_FAST_MIN_INT);
+		this->advertising->setMaxInterval(HID2BLE_ADV_FAST_MIN_INT);
+		this->advertising->start(HID2BLE_ADV_DIRECTED_MS, nullptr, &addr);
+		return;
+	}
+
+	this->advertising->setAdvertisementType(BLE_GAP_CONN_MODE_UND);
+	if (phase == HID2BLE_ADV_FAST)
+	{
+		this->advertising->setMinInterval(HID2BLE_ADV_FAST_MIN_INT);
+		this->advertising->setMaxInterval(HID2BLE_ADV_FAST_MAX_INT);
+	}
+	else
+	{
+		this->advertising->setMinInterval(HID2BLE_ADV_SLOW_MIN_INT);
+		this->advertising->setMaxInterval(HID2BLE_ADV_SLOW_MAX_INT);
+	}
+	this->advertising->start();
+}
+
+void Hid2Ble::advertiseStop(uint8_t phase)
+{
+	this->advertising->stop();
+}
+
+#endif
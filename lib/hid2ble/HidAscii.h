@@ -0,0 +1,188 @@
+#ifndef HID_ASCII_H
+#define HID_ASCII_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * ASCII -> HID 键码查找表 (美式键盘布局)
+ * 低 7 位为键码 (Usage ID)，最高位表示需要按住 Left Shift；0 表示无法输入的字符
+ * 控制字符只映射 退格/Tab/换行(回车)/Esc，DEL 映射为 Delete
+ */
+#define HID_ASCII_SHIFT 0x80
+#define HID_ASCII_USAGE_MASK 0x7F
+#define HID_ASCII_MOD_SHIFT 0x02 // Left Shift 修饰位
+
+static const uint8_t hidAsciiMap[128] = {
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 00-07 . . . . . . . .
+  0x2A, 0x2B, 0x28, 0x00, 0x00, 0x00, 0x00, 0x00, // 08-0F BS TAB LF . . . . .
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 10-17 . . . . . . . .
+  0x00, 0x00, 0x00, 0x29, 0x00, 0x00, 0x00, 0x00, // 18-1F . . . ESC . . . .
+  0x2C, 0x9E, 0xB4, 0xA0, 0xA1, 0xA2, 0xA4, 0x34, // 20-27 SP ! " # $ % & '
+  0xA6, 0xA7, 0xA5, 0xAE, 0x36, 0x2D, 0x37, 0x38, // 28-2F ( ) * + , - . /
+  0x27, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24, // 30-37 0 1 2 3 4 5 6 7
+  0x25, 0x26, 0xB3, 0x33, 0xB6, 0x2E, 0xB7, 0xB8, // 38-3F 8 9 : ; < = > ?
+  0x9F, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, // 40-47 @ A B C D E F G
+  0x8B, 0x8C, 0x8D, 0x8E, 0x8F, 0x90, 0x91, 0x92, // 48-4F H I J K L M N O
+  0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, // 50-57 P Q R S T U V W
+  0x9B, 0x9C, 0x9D, 0x2F, 0x31, 0x30, 0xA3, 0xAD, // 58-5F X Y Z [ \ ] ^ _
+  0x35, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, // 60-67 ` a b c d e f g
+  0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10, 0x11, 0x12, // 68-6F h i j k l m n o
+  0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, // 70-77 p q r s t u v w
+  0x1B, 0x1C, 0x1D, 0xAF, 0xB1, 0xB0, 0xB5, 0x4C, // 78-7F x y z { | } ~ DEL
+};
+
+/**
+ * 查找字符对应的修饰键与键码
+ * 非 ASCII (含 UTF-8 多字节序列中的字节) 及不可输入的字符返回 false
+ */
+static inline bool hidAsciiLookup(uint8_t c, uint8_t *mods, uint8_t *usage)
+{
+  uint8_t v;
+
+  if (c >= 128 || (v = hidAsciiMap[c]) == 0)
+  {
+    return false;
+  }
+  *usage = v & HID_ASCII_USAGE_MASK;
+  *mods = (v & HID_ASCII_SHIFT) ? HID_ASCII_MOD_SHIFT : 0;
+  return true;
+}
+
+/**
+ * 文本打包器：把连续的字符合并为尽量少的键盘报文
+ * - 修饰键相同且键码互不相同的连续字符 (最多 maxKeys 个) 在同一个报文中一起按下
+ * - 下一组与上一组没有相同键码且修饰键相同时直接发送下一组 (主机看到旧键释放、新键按下)，
+ *   只有字符重复或修饰键变化时才插入全空的释放报文
+ * 同一报文内的按键按字符顺序排列，主机按数组顺序处理新按下的键；maxKeys = 1 时退化为逐字符输入
+ */
+#define HID_TYPER_REPORT_LEN 8
+
+struct HidTyper
+{
+  const uint8_t *p;                    // 下一个待打包的字节
+  uint8_t maxKeys;                     // 每个报文最多同时按下的键数 (1-6)
+  bool held;                           // last 中有按键未释放
+  uint8_t last[HID_TYPER_REPORT_LEN];  // 上一个输出的报文
+  uint32_t chars;                      // 已输出的字符数
+  uint32_t skipped;                    // 跳过的字符数 (不可输入的 ASCII 与非 ASCII 字符)
+};
+
+/**
+ * 开始打包文本 (text 在打包结束前必须保持有效)
+ */
+static inline void hidTyperBegin(struct HidTyper *t, const char *text, uint8_t maxKeys)
+{
+  t->p = (const uint8_t *)text;
+  t->maxKeys = maxKeys == 0 ? 1 : (maxKeys > 6 ? 6 : maxKeys);
+  t->held = false;
+  for (int i = 0; i < HID_TYPER_REPORT_LEN; i++)
+  {
+    t->last[i] = 0;
+  }
+  t->chars = 0;
+  t->skipped = 0;
+}
+
+/**
+ * 跳过一个无法输入的字符 (UTF-8 多字节序列整体跳过)，返回下一个字符位置
+ */
+static inline const uint8_t *hidTyperSkip(const uint8_t *q)
+{
+  if (*q++ >= 0x80)
+  {
+    while ((*q & 0xC0) == 0x80)
+    {
+      q++;
+    }
+  }
+  return q;
+}
+
+/**
+ * 输出下一个报文
+ * 返回 false 表示文本已结束且最后的释放报文已输出
+ */
+static inline bool hidTyperNext(struct HidTyper *t, uint8_t *report)
+{
+  uint8_t r[HID_TYPER_REPORT_LEN] = {0};
+  uint8_t n = 0, mods = 0, usage, m;
+  uint32_t skipped = 0;
+  const uint8_t *q;
+
+  // 组首的不可输入字符直接跳过
+  while (*t->p && !hidAsciiLookup(*t->p, &m, &usage))
+  {
+    t->p = hidTyperSkip(t->p);
+    t->skipped++;
+  }
+
+  q = t->p;
+  while (*q && n < t->maxKeys)
+  {
+    bool dup = false;
+
+    if (!hidAsciiLookup(*q, &m, &usage))
+    {
+      q = hidTyperSkip(q);
+      skipped++;
+      continue;
+    }
+    for (int i = 0; i < n; i++)
+    {
+      dup |= r[2 + i] == usage;
+    }
+    if (n > 0 && (m != mods || dup))
+    {
+      break;
+    }
+    mods = m;
+    r[0] = m;
+    r[2 + n++] = usage;
+    q++;
+  }
+
+  if (n > 0 && t->held)
+  {
+    bool overlap = t->last[0] != mods;
+
+    for (int i = 2; i < HID_TYPER_REPORT_LEN && !overlap; i++)
+    {
+      for (int k = 0; k < n && !overlap; k++)
+      {
+        overlap = t->last[i] != 0 && t->last[i] == r[2 + k];
+      }
+    }
+    if (!overlap)
+    {
+      t->held = false; // 直接切换到下一组
+    }
+  }
+
+  if (t->held)
+  {
+    // 文本结束或与上一组冲突：先释放 (下次调用重新打包同一组)
+    for (int i = 0; i < HID_TYPER_REPORT_LEN; i++)
+    {
+      report[i] = t->last[i] = 0;
+    }
+    t->held = false;
+    return true;
+  }
+  if (n == 0)
+  {
+    return false;
+  }
+
+  for (int i = 0; i < HID_TYPER_REPORT_LEN; i++)
+  {
+    report[i] = t->last[i] = r[i];
+  }
+  t->held = true;
+  t->p = q;
+  t->chars += n;
+  t->skipped += skipped;
+  return true;
+}
+
+#endif
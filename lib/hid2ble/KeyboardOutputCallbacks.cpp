@@ -12,8 +12,8 @@ KeyboardOutputCallbacks::KeyboardOutputCallbacks(void)
 {
 }
 
-void KeyboardOutputCallbacks::onWrite(BLECharacteristic *me)
+void KeyboardOutputCallbacks::onWrite(KeyboardOutputCharacteristic *me)
 {
-  uint8_t *value = (uint8_t *)(me->getValue().c_str());
+  uint8_t *value = (uint8_t *)(me->getValue().data());
   ESP_LOGI(LOG_TAG, "special keys: %d", *value);
 }
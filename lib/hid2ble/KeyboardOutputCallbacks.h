@@ -3,15 +3,23 @@
 #include "sdkconfig.h"
 #if defined(CONFIG_BT_ENABLED)
 
+#if defined(HID2BLE_USE_NIMBLE)
+#include <NimBLECharacteristic.h>
+typedef NimBLECharacteristic KeyboardOutputCharacteristic;
+typedef NimBLECharacteristicCallbacks KeyboardOutputCallbacksBase;
+#else
 #include <BLEServer.h>
 #include "BLE2902.h"
 #include "BLECharacteristic.h"
+typedef BLECharacteristic KeyboardOutputCharacteristic;
+typedef BLECharacteristicCallbacks KeyboardOutputCallbacksBase;
+#endif
 
-class KeyboardOutputCallbacks : public BLECharacteristicCallbacks
+class KeyboardOutputCallbacks : public KeyboardOutputCallbacksBase
 {
 public:
   KeyboardOutputCallbacks(void);
-  void onWrite(BLECharacteristic *me);
+  void onWrite(KeyboardOutputCharacteristic *me);
 };
 
 #endif
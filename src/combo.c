@@ -0,0 +1,210 @@
+/**
+  ******************************************************************************
+  * @file    combo.c
+  * @brief   组合键 (combo / chord) 识别引擎
+  * @note    组合表在设置时预编译为按键集合 (5 键共 32 种) 的查找表：
+  *          - cmbMatch: 集合恰好等于某个组合
+  *          - cmbPrefix: 集合是某个组合的真子集，继续按键仍可能组成组合
+  *          每个事件只做一次查表，耗时固定。只有参与组合的按键才会被缓存，且最多缓存一个组合窗口，
+  *          其他按键的事件直接转发，没有额外延迟
+  ******************************************************************************
+  */
+
+#include "combo.h"
+
+// 组合表与预编译查找表
+static CMB_Combo cmbTable[CMB_MAX_COMBOS];
+static uint8_t cmbMatch[CMB_MASK_COUNT];  // 集合 -> 组合序号 + 1，0 表示无
+static uint32_t cmbPrefix = 0;            // bit m: 集合 m 是某个组合的真子集
+static uint32_t cmbUseful = 0;            // bit m: 集合 m 是某个组合的子集 (含相等)
+static uint8_t cmbKeys = 0;               // 参与任何组合的按键
+static uint32_t cmbWindowUs = CMB_WINDOW_MS * 1000UL;
+
+static void (*cmbNext)(const KeyEvent *evt) = NULL;
+static TH_ActionSink cmbSink = NULL;
+
+// 窗口内缓存的按下事件
+static uint8_t cmbPending = 0;            // 缓存的按键集合
+static KeyEvent cmbBuf[CMB_KEY_COUNT];
+static uint8_t cmbBufLen = 0;
+static uint32_t cmbDeadline = 0;          // 窗口到期时间 (事件时间戳, us)
+
+// 已触发的组合
+static uint8_t cmbConsumed = 0;           // 组合占用的按键，其后续事件不再转发
+static int8_t cmbFired = -1;              // 生效中的组合序号，-1 表示无
+
+static CMB_Stats cmbStats = {0, 0, 0};
+
+/**
+  * @brief  结束生效中的组合动作
+  */
+static void CMB_ReleaseFired(void) {
+    if (cmbFired >= 0) {
+        if (cmbSink) {
+            cmbSink(CMB_SOURCE, &cmbTable[cmbFired].action, false);
+        }
+        cmbFired = -1;
+    }
+}
+
+/**
+  * @brief  结束等待：缓存的集合恰好是组合则触发，否则按原顺序、原时间戳转发缓存的按下事件
+  * @retval None
+  */
+static void CMB_Resolve(void) {
+    uint8_t idx = cmbMatch[cmbPending];
+
+    KEY_CancelDeadline();
+
+    if (idx) {
+        CMB_ReleaseFired();
+        cmbFired = idx - 1;
+        cmbConsumed |= cmbPending;
+        cmbStats.fired++;
+        if (cmbSink) {
+            cmbSink(CMB_SOURCE, &cmbTable[cmbFired].action, true);
+        }
+    } else {
+        for (uint8_t i = 0; i < cmbBufLen; i++) {
+            if (cmbNext) {
+                cmbNext(&cmbBuf[i]);
+            }
+        }
+        cmbStats.flushed += cmbBufLen;
+    }
+
+    cmbPending = 0;
+    cmbBufLen = 0;
+}
+
+/**
+  * @brief  初始化引擎
+  * @param  next 下游事件处理
+  * @param  sink 组合动作输出回调
+  * @retval None
+  */
+void CMB_Init(void (*next)(const KeyEvent *evt), TH_ActionSink sink) {
+    cmbNext = next;
+    cmbSink = sink;
+    cmbPending = 0;
+    cmbBufLen = 0;
+    cmbConsumed = 0;
+    cmbFired = -1;
+}
+
+/**
+  * @brief  设置组合表并预编译查找表
+  * @note   少于两个键的组合忽略
+  * @param  combos   组合数组
+  * @param  count    组合数
+  * @param  windowMs 组合窗口，0 表示使用 CMB_WINDOW_MS
+  * @retval None
+  */
+void CMB_SetCombos(const CMB_Combo *combos, uint8_t count, uint16_t windowMs) {
+    uint8_t n = 0;
+
+    memset(cmbMatch, 0, sizeof(cmbMatch));
+    cmbPrefix = 0;
+    cmbUseful = 0;
+    cmbKeys = 0;
+
+    for (uint8_t i = 0; i < count && n < CMB_MAX_COMBOS; i++) {
+        uint8_t mask = combos[i].mask & (CMB_MASK_COUNT - 1);
+
+        if (__builtin_popcount(mask) < 2) {
+            continue;
+        }
+        cmbTable[n] = combos[i];
+        cmbMatch[mask] = ++n;
+        cmbKeys |= mask;
+
+        for (uint8_t m = 1; m < CMB_MASK_COUNT; m++) {
+            if ((m & mask) == m) {
+                cmbUseful |= 1UL << m;
+                if (m != mask) {
+                    cmbPrefix |= 1UL << m;
+                }
+            }
+        }
+    }
+
+    cmbWindowUs = (uint32_t)(windowMs ? windowMs : CMB_WINDOW_MS) * 1000;
+}
+
+/**
+  * @brief  处理一个按键事件
+  * @note   按下：不参与组合的键先结束等待再转发；参与组合的键加入缓存集合，
+  *         集合无法再扩展时立即判定，否则等到窗口到期 (KEY_EVT_TIMEOUT) 或缓存的键被释放。
+  *         组合触发后，其按键的释放/保持事件不再转发，第一个释放的键结束组合动作
+  * @param  evt 按键事件
+  * @retval None
+  */
+void CMB_Process(const KeyEvent *evt) {
+    uint8_t bit = 1 << evt->key;
+    uint8_t m;
+
+    switch (evt->type) {
+    case KEY_EVT_PRESS:
+        if (!(cmbKeys & bit)) {
+            if (cmbPending) {
+                CMB_Resolve();
+            }
+            break;
+        }
+
+        m = cmbPending | bit;
+        if (cmbPending && !(cmbUseful & (1UL << m))) {
+            CMB_Resolve(); // 加入该键后不可能组成组合，该键重新开始一个窗口
+            m = bit;
+        }
+        if (!cmbPending) {
+            cmbDeadline = evt->time + cmbWindowUs;
+            KEY_SetDeadline(cmbDeadline);
+        }
+        cmbPending = m;
+        cmbBuf[cmbBufLen++] = *evt;
+
+        if (!(cmbPrefix & (1UL << m))) {
+            CMB_Resolve();
+        }
+        return;
+
+    case KEY_EVT_RELEASE:
+    case KEY_EVT_HOLD:
+        if (cmbPending & bit) {
+            CMB_Resolve();
+        }
+        if (cmbConsumed & bit) {
+            if (evt->type == KEY_EVT_RELEASE) {
+                cmbConsumed &= ~bit;
+                CMB_ReleaseFired();
+            }
+            return;
+        }
+        break;
+
+    case KEY_EVT_TIMEOUT:
+        // 忽略已提前判定的窗口遗留在队列中的超时事件
+        if (cmbPending && (int32_t)(evt->time - cmbDeadline) >= 0) {
+            cmbStats.timeouts++;
+            CMB_Resolve();
+        }
+        return;
+
+    default:
+        break;
+    }
+
+    if (cmbNext) {
+        cmbNext(evt);
+    }
+}
+
+/**
+  * @brief  获取引擎统计
+  * @param  stats 输出统计
+  * @retval None
+  */
+void CMB_GetStats(CMB_Stats *stats) {
+    *stats = cmbStats;
+}
@@ -0,0 +1,203 @@
+/**
+  ******************************************************************************
+  * @file    hidReport.c
+  * @brief   HID 键盘报文合成器
+  * @note    按按下先后顺序合并所有按住来源的修饰键和键码，生成单个 6KRO 报文，
+  *          键数超出或键码超出 6KRO 范围时改用 NKRO 位图 (Report ID 3)，
+  *          并且只在报文内容变化时才要求发送，避免和弦时多次通知及释放竞争
+  ******************************************************************************
+  */
+
+#include "hidReport.h"
+
+// 按住的来源，按按下先后排列 (heldOrder[0] 最早)
+static uint8_t heldOrder[HID_MAX_SOURCES];
+static uint8_t heldCount = 0;
+
+// 各来源登记的报文
+static uint8_t srcReport[HID_MAX_SOURCES][HID_REPORT_LEN];
+
+// 上次合成 (已发送) 的报文
+static uint8_t lastBoot[HID_REPORT_LEN] = {0};
+static uint8_t lastNkro[HID_NKRO_LEN] = {0};
+static bool lastValid = true;
+
+static HID_ReportMode hidMode = HID_MODE_6KRO;
+static bool nkroEnabled = true;
+
+static HID_Stats hidStats = {0, 0, 0, 0, 0};
+
+/**
+  * @brief  在按下顺序表中查找来源
+  * @retval 位置，未找到返回 -1
+  */
+static int HID_FindHeld(uint8_t src) {
+    for (int i = 0; i < heldCount; i++) {
+        if (heldOrder[i] == src) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+  * @brief  来源按下
+  * @param  src    来源索引
+  * @param  report 8 字节报文
+  * @retval None
+  */
+void HID_KeyDown(uint8_t src, const uint8_t *report) {
+    if (src >= HID_MAX_SOURCES) {
+        return;
+    }
+
+    memcpy(srcReport[src], report, HID_REPORT_LEN);
+
+    // 重复按下只更新报文，不改变顺序
+    if (HID_FindHeld(src) < 0) {
+        heldOrder[heldCount++] = src;
+    }
+}
+
+/**
+  * @brief  来源释放
+  * @param  src 来源索引
+  * @retval None
+  */
+void HID_KeyUp(uint8_t src) {
+    int pos = HID_FindHeld(src);
+
+    if (pos < 0) {
+        return;
+    }
+
+    // 保持其余来源的先后顺序
+    memmove(&heldOrder[pos], &heldOrder[pos + 1], heldCount - pos - 1);
+    heldCount--;
+}
+
+/**
+  * @brief  清空所有按住的来源
+  * @param  None
+  * @retval None
+  */
+void HID_Reset() {
+    heldCount = 0;
+}
+
+/**
+  * @brief  将按住来源的键码按先后顺序收集到 6KRO 报文中
+  * @note   修饰键按位或；键码依次追加并去重，先按下的键保持在前面的槽位
+  * @param  boot 输出 8 字节报文
+  * @param  nkro 输出位图 (同时记录全部键码)
+  * @retval 去重后的普通键码总数 (可能大于 6)
+  */
+static uint8_t HID_Collect(uint8_t *boot, uint8_t *nkro, bool *highUsage) {
+    uint8_t n = 0;
+
+    for (int i = 0; i < heldCount; i++) {
+        const uint8_t *r = srcReport[heldOrder[i]];
+
+        boot[0] |= r[0];
+        for (int k = 2; k < HID_REPORT_LEN; k++) {
+            uint8_t code = r[k];
+
+            if (code == 0 || code > 0xE7 || (nkro[code >> 3] & (1 << (code & 7)))) {
+                continue; // 空槽、超出位图范围或重复
+            }
+            nkro[code >> 3] |= 1 << (code & 7);
+            if (code > HID_BOOT_MAX_USAGE) {
+                *highUsage = true;
+            }
+            if (n < HID_MAX_KEYS) {
+                boot[2 + n] = code;
+            }
+            n++;
+        }
+    }
+    nkro[HID_NKRO_MOD_BYTE] |= boot[0];
+
+    return n;
+}
+
+/**
+  * @brief  合成当前报文
+  * @note   6KRO 下超过 6 个键码 (且未启用 NKRO) 时按 HID 规范全部填 ErrorRollOver
+  * @param  out 输出合成结果
+  * @retval 需要发送的报文 (HID_SEND_BOOT / HID_SEND_NKRO 的组合)
+  */
+uint8_t HID_Compose(HID_Output *out) {
+    bool highUsage = false;
+    uint8_t n;
+    uint8_t send = 0;
+
+    memset(out->boot, 0, HID_REPORT_LEN);
+    memset(out->nkro, 0, HID_NKRO_LEN);
+    n = HID_Collect(out->boot, out->nkro, &highUsage);
+
+    // 模式选择：需要时进入 NKRO，全部释放后回到 6KRO
+    if (nkroEnabled && (n > HID_MAX_KEYS || highUsage)) {
+        if (hidMode != HID_MODE_NKRO) {
+            hidStats.nkroSwitch++;
+        }
+        hidMode = HID_MODE_NKRO;
+    } else if (heldCount == 0 || !nkroEnabled) {
+        hidMode = HID_MODE_6KRO;
+    }
+    out->mode = hidMode;
+
+    if (hidMode == HID_MODE_NKRO) {
+        memset(out->boot, 0, HID_REPORT_LEN);
+    } else {
+        if (n > HID_MAX_KEYS) {
+            memset(&out->boot[2], HID_ERR_ROLLOVER, HID_MAX_KEYS);
+            hidStats.rollover++;
+        }
+        memset(out->nkro, 0, HID_NKRO_LEN);
+    }
+
+    hidStats.composed++;
+    if (!lastValid || memcmp(out->boot, lastBoot, HID_REPORT_LEN) != 0) {
+        memcpy(lastBoot, out->boot, HID_REPORT_LEN);
+        send |= HID_SEND_BOOT;
+    }
+    if (!lastValid || memcmp(out->nkro, lastNkro, HID_NKRO_LEN) != 0) {
+        memcpy(lastNkro, out->nkro, HID_NKRO_LEN);
+        send |= HID_SEND_NKRO;
+    }
+    lastValid = true;
+
+    if (send) {
+        hidStats.sent++;
+    } else {
+        hidStats.suppressed++;
+    }
+    return send;
+}
+
+/**
+  * @brief  启用/禁用 NKRO
+  * @param  enabled 是否启用
+  * @retval None
+  */
+void HID_SetNkroEnabled(bool enabled) {
+    nkroEnabled = enabled;
+}
+
+/**
+  * @brief  强制下一次合成视为变化
+  * @param  None
+  * @retval None
+  */
+void HID_Invalidate() {
+    lastValid = false;
+}
+
+/**
+  * @brief  获取合成器统计
+  * @param  stats 输出
+  * @retval None
+  */
+void HID_GetStats(HID_Stats *stats) {
+    *stats = hidStats;
+}
@@ -1,7 +1,15 @@
 #include "iic.h"
 
+#ifndef IIC_HAL_MOCK
+#include "driver/i2c.h"
+#endif
+
 static IIC_BusCfg IIC_Bus[8];
 
+#ifdef IIC_HAL_MOCK
+IIC_MockRegs IIC_Mock;
+#endif
+
 /**
 	* @brief  软件IIC初始化函数
 	* @param  SCL SCL引脚号
@@ -12,35 +20,80 @@ static IIC_BusCfg IIC_Bus[8];
 	*/
 void IIC_Init(uint8_t SCL, uint8_t SDA, uint8_t spd, uint8_t bus) {
 
+	IIC_Bus[bus].Backend = IIC_BACKEND_SOFT;
 	IIC_Bus[bus].SCL_Pin = SCL;
 	IIC_Bus[bus].SDA_Pin = SDA;
 	IIC_Bus[bus].Delay = spd;
+	IIC_Bus[bus].SCL_Mask = 1UL << SCL;
+	IIC_Bus[bus].SDA_Mask = 1UL << SDA;
+
+	IIC_HAL_PinMode(SCL, OUTPUT);
+	IIC_HAL_PinMode(SDA, OUTPUT);
+
+	IIC_HAL_Set(IIC_Bus[bus].SCL_Mask | IIC_Bus[bus].SDA_Mask);
+}
 
-    pinMode(OLED_SCL, OUTPUT);
-    pinMode(OLED_SDA, OUTPUT);
+/**
+	* @brief  硬件IIC初始化函数，失败时自动退回软件IIC
+	* @param  SCL SCL引脚号
+	* @param  SDA SDA引脚号
+	* @param  freq 总线时钟频率，单位为Hz (如 400000)
+	* @param  bus 绑定到硬件控制器的总线号，范围 0-7
+	* @retval 1 使用硬件控制器, 0 已退回软件IIC
+	*/
+uint8_t IIC_InitHW(uint8_t SCL, uint8_t SDA, uint32_t freq, uint8_t bus) {
+#ifndef IIC_HAL_MOCK
+	i2c_config_t conf = {
+		.mode = I2C_MODE_MASTER,
+		.sda_io_num = SDA,
+		.scl_io_num = SCL,
+		.sda_pullup_en = GPIO_PULLUP_ENABLE,
+		.scl_pullup_en = GPIO_PULLUP_ENABLE,
+		.master.clk_speed = freq,
+	};
+
+	if (i2c_param_config(IIC_HW_PORT, &conf) == ESP_OK &&
+		i2c_driver_install(IIC_HW_PORT, I2C_MODE_MASTER, 0, 0, 0) == ESP_OK) {
+		IIC_Bus[bus].Backend = IIC_BACKEND_HW;
+		IIC_Bus[bus].SCL_Pin = SCL;
+		IIC_Bus[bus].SDA_Pin = SDA;
+		return 1;
+	}
+#else
+	(void)freq;
+#endif
 
-	digitalWrite(SCL, HIGH);
-	digitalWrite(SDA, HIGH);
+	IIC_Init(SCL, SDA, 0, bus);
+	return 0;
 }
 
-void wSCL(uint8_t bus, uint8_t state) {
-	digitalWrite(IIC_Bus[bus].SCL_Pin, state);
+// 以下电平操作直接写 GPIO 置位/清零寄存器，绕过 digitalWrite 的引脚查表
+static inline void wSCL(uint8_t bus, uint8_t state) {
+	if (state) {
+		IIC_HAL_Set(IIC_Bus[bus].SCL_Mask);
+	} else {
+		IIC_HAL_Clr(IIC_Bus[bus].SCL_Mask);
+	}
 	if (IIC_Bus[bus].Delay > 0) {
-		delayMicroseconds(IIC_Bus[bus].Delay);
+		IIC_HAL_Delay(IIC_Bus[bus].Delay);
 	}
 }
 
-void wSDA(uint8_t bus, uint8_t state) {
-	digitalWrite(IIC_Bus[bus].SDA_Pin, state);
+static inline void wSDA(uint8_t bus, uint8_t state) {
+	if (state) {
+		IIC_HAL_Set(IIC_Bus[bus].SDA_Mask);
+	} else {
+		IIC_HAL_Clr(IIC_Bus[bus].SDA_Mask);
+	}
 	if (IIC_Bus[bus].Delay > 0) {
-		delayMicroseconds(IIC_Bus[bus].Delay);
+		IIC_HAL_Delay(IIC_Bus[bus].Delay);
 	}
 }
 
-uint8_t rSDA(uint8_t bus) {
-	uint8_t state = digitalRead(IIC_Bus[bus].SDA_Pin);
+static inline uint8_t rSDA(uint8_t bus) {
+	uint8_t state = (IIC_HAL_Read() & IIC_Bus[bus].SDA_Mask) ? HIGH : LOW;
 	if (IIC_Bus[bus].Delay > 0) {
-		delayMicroseconds(IIC_Bus[bus].Delay);
+		IIC_HAL_Delay(IIC_Bus[bus].Delay);
 	}
 	return state;
 }
@@ -140,3 +193,45 @@ void IIC_SendACK(uint8_t bus, uint8_t ack) {
 	wSCL(bus, HIGH);
 	wSCL(bus, LOW);
 }
+
+
+/**
+	* @brief  软件IIC连续写入，整个传输只产生一次 Start/地址/控制字节/Stop
+	* @param  bus 当前操作的软件IIC总线号，范围 0-7
+	* @param  addr 从机地址 (含读写位的 8 位地址)
+	* @param  ctrl 紧随地址发送的控制字节
+	* @param  data 需要发送的数据
+	* @param  len 数据长度
+	* @retval 传输是否成功 (硬件后端以控制器返回值为准；软件后端不检查应答，总是成功)
+	*/
+bool IIC_WriteBurst(uint8_t bus, uint8_t addr, uint8_t ctrl, const uint8_t* data, uint16_t len) {
+	uint16_t i;
+
+#ifndef IIC_HAL_MOCK
+	if (IIC_Bus[bus].Backend == IIC_BACKEND_HW) {
+		// 整个传输作为一条命令链交给控制器，CPU 在等待期间可调度其他任务
+		static uint8_t linkBuf[I2C_LINK_RECOMMENDED_SIZE(3)];
+		i2c_cmd_handle_t cmd = i2c_cmd_link_create_static(linkBuf, sizeof(linkBuf));
+		i2c_master_start(cmd);
+		i2c_master_write_byte(cmd, addr, true);
+		i2c_master_write_byte(cmd, ctrl, true);
+		i2c_master_write(cmd, data, len, true);
+		i2c_master_stop(cmd);
+		esp_err_t err = i2c_master_cmd_begin(IIC_HW_PORT, cmd, pdMS_TO_TICKS(IIC_HW_TIMEOUT_MS));
+		i2c_cmd_link_delete_static(cmd);
+		return err == ESP_OK;
+	}
+#endif
+
+	IIC_Start(bus);
+	IIC_SendByte(bus, addr);
+	IIC_RcvACK(bus);
+	IIC_SendByte(bus, ctrl);
+	IIC_RcvACK(bus);
+	for (i = 0; i < len; i++) {
+		IIC_SendByte(bus, data[i]);
+		IIC_RcvACK(bus);
+	}
+	IIC_Stop(bus);
+	return true;
+}
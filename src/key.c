@@ -2,14 +2,14 @@
   ******************************************************************************
   * @file    key.cpp
   * @brief   按键驱动及状态机处理
-  * @note    包含按键去抖、状态更新及所有按键的长按检测逻辑
+  * @note    包含按键去抖 (位并行垂直计数器)、状态更新及所有按键的保持 (长按) 检测逻辑
   ******************************************************************************
   */
 
 #include "key.h"
-
-// 宏定义：读取按键物理电平 (假设低电平有效)
-#define pressed(key) !digitalRead(key)
+#include "soc/soc.h"
+#include "soc/gpio_reg.h"
+#include "esp_timer.h"
 
 // 全局使能标志
 bool enableKey = true;
@@ -26,25 +26,180 @@ KeyState keyState[5] = {
     { false, false, false }
 };
 
-// 标志位：对应按键是否触发了长按
-bool keyLongPressed[5] = {false, false, false, false, false};
-// 计时器：记录按下时的系统时间
-uint32_t keyPressStartTime[5] = {0, 0, 0, 0, 0};
+// --- 扫描与去抖 (KEY_Scan，在定时器中断中运行) ---
+// 以下集合均为位掩码：bit i 对应 Key i+1
+static uint32_t keyPinMask[5];             // 各按键在 GPIO_IN 寄存器中的位
+static volatile uint8_t keyStable = 0;     // 去抖后的按下集合
+static uint8_t keyCnt0 = 0, keyCnt1 = 0;   // 垂直计数器的低位/高位平面 (每个按键一个 2 位计数器)
+static uint8_t keyHoldFired = 0;           // 本次按下已上报过保持事件的按键
+static uint8_t keyPressAcc = 0;            // 累计的按下沿 (changed & stable)，由 KEY_Update 取走
+static uint8_t keyReleaseAcc = 0;          // 累计的释放沿 (changed & ~stable)
+static uint32_t keyHoldUs[5] = {           // 各按键的保持时间 (us)，0 表示不上报
+    LONG_PRESS_TIME * 1000UL, LONG_PRESS_TIME * 1000UL, LONG_PRESS_TIME * 1000UL,
+    LONG_PRESS_TIME * 1000UL, LONG_PRESS_TIME * 1000UL
+};
+static uint32_t keyDeadline = 0;           // KEY_SetDeadline 的到期时间 (事件时间戳, us)
+static bool keyDeadlineArmed = false;
+static uint8_t scanDivider = 1;            // 每 scanDivider 次扫描采样一次
+static uint8_t scanCnt = 0;
+static portMUX_TYPE keyMux = portMUX_INITIALIZER_UNLOCKED;
+
+// --- 边沿中断捕获 (KEY_INPUT_IRQ) ---
+static KEY_InputMode inputMode = KEY_INPUT_SCAN;
+static volatile uint8_t keyLockout = 0;    // 处于锁定期的按键，期间忽略边沿并暂停计数
+static volatile int64_t keyEdgeTime[5];    // 最近一次状态翻转的时间戳 (us)
+static uint32_t lockoutUs = KEY_DEBOUNCE_MS * 1000; // 锁定期 = 去抖窗口
 
-// 全局标志：请求发送释放报文
-bool sendRelease = false;
+// --- 事件环形队列 (中断生产，主循环消费) ---
+// 生产端 (边沿中断 / 扫描中断) 之间由 keyMux 串行化，消费端只有主循环，
+// 读写指针各由一方独占写入，因此消费端无需加锁
+static KeyEvent keyEvtBuf[KEY_EVENT_QUEUE_LEN];
+static volatile uint8_t keyEvtHead = 0;    // 写指针，仅生产端修改
+static volatile uint8_t keyEvtTail = 0;    // 读指针，仅消费端修改
+static volatile uint32_t keyEvtOverflow = 0; // 队列满而丢弃的事件数
+static volatile uint8_t keyEvtMaxDepth = 0;  // 历史最大队列深度
+static void (*keyTickCallback)(void) = NULL;
+static void (*keyEventCallback)(const KeyEvent *evt) = NULL;
 
-// --- HID 报文缓冲区定义 ---
-// 格式: [修饰键, 保留, 键码1, 键码2, 键码3, 键码4, 键码5, 键码6]
-char k1Buf[8] = { 0x01, 0x00, 0x1B, 0x00, 0x00, 0x00, 0x00, 0x00 }; // Ctrl + X (剪切)
-char k2Buf[8] = { 0x01, 0x00, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00 }; // Ctrl + C (复制)
-char k3Buf[8] = { 0x01, 0x00, 0x19, 0x00, 0x00, 0x00, 0x00, 0x00 }; // Ctrl + V (粘贴)
-char k4Buf[8] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }; // 预留
-char k5Buf[8] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }; // 预留
+// --- 本次 KEY_Update 取走的边沿集合 (主循环) ---
+static uint8_t keyPressEdges = 0;
+static uint8_t keyReleaseEdges = 0;
 
 // 空报文 (释放所有按键)
 char release[8] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }; 
 
+/**
+  * @brief  向事件队列写入一个事件 (生产端，中断上下文)
+  * @note   调用方需已持有 keyMux 或处于不会被其他生产者打断的上下文
+  * @param  type 事件类型
+  * @param  key  按键索引 (0-4)，TICK 事件为 0
+  * @param  time 事件时间戳 (us)
+  * @retval None
+  */
+static void IRAM_ATTR KEY_PushEvent(KeyEventType type, uint8_t key, uint32_t time) {
+    uint8_t head = keyEvtHead;
+    uint8_t depth = (uint8_t)(head - __atomic_load_n(&keyEvtTail, __ATOMIC_ACQUIRE));
+
+    if (depth >= KEY_EVENT_QUEUE_LEN) {
+        keyEvtOverflow++;
+        return;
+    }
+    keyEvtBuf[head & (KEY_EVENT_QUEUE_LEN - 1)].time = time;
+    keyEvtBuf[head & (KEY_EVENT_QUEUE_LEN - 1)].type = type;
+    keyEvtBuf[head & (KEY_EVENT_QUEUE_LEN - 1)].key = key;
+    __atomic_store_n(&keyEvtHead, (uint8_t)(head + 1), __ATOMIC_RELEASE);
+
+    if (depth + 1 > keyEvtMaxDepth) {
+        keyEvtMaxDepth = depth + 1;
+    }
+}
+
+/**
+  * @brief  投递一个秒计时 (TICK) 事件
+  * @note   由定时器中断调用，主循环在 KEY_Update 中分发给 tick 回调
+  * @param  None
+  * @retval None
+  */
+void IRAM_ATTR KEY_PostTick() {
+    portENTER_CRITICAL_ISR(&keyMux);
+    KEY_PushEvent(KEY_EVT_TICK, 0, (uint32_t)esp_timer_get_time());
+    portEXIT_CRITICAL_ISR(&keyMux);
+}
+
+/**
+  * @brief  从事件队列取出一个事件 (消费端，主循环)
+  * @param  evt 输出事件
+  * @retval bool 是否取到事件
+  */
+bool KEY_PopEvent(KeyEvent *evt) {
+    uint8_t tail = keyEvtTail;
+
+    if (tail == __atomic_load_n(&keyEvtHead, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+    *evt = keyEvtBuf[tail & (KEY_EVENT_QUEUE_LEN - 1)];
+    __atomic_store_n(&keyEvtTail, (uint8_t)(tail + 1), __ATOMIC_RELEASE);
+    return true;
+}
+
+/**
+  * @brief  获取事件队列统计
+  * @param  depth    当前队列深度 (可为 NULL)
+  * @param  maxDepth 历史最大深度 (可为 NULL)
+  * @param  overflow 溢出丢弃的事件数 (可为 NULL)
+  * @retval None
+  */
+void KEY_GetEventStats(uint8_t *depth, uint8_t *maxDepth, uint32_t *overflow) {
+    if (depth) {
+        *depth = (uint8_t)(__atomic_load_n(&keyEvtHead, __ATOMIC_ACQUIRE) - keyEvtTail);
+    }
+    if (maxDepth) {
+        *maxDepth = keyEvtMaxDepth;
+    }
+    if (overflow) {
+        *overflow = keyEvtOverflow;
+    }
+}
+
+/**
+  * @brief  注册 TICK 事件回调 (在主循环上下文中执行)
+  * @param  cb 回调函数，NULL 表示忽略 TICK 事件
+  * @retval None
+  */
+void KEY_SetTickCallback(void (*cb)(void)) {
+    keyTickCallback = cb;
+}
+
+/**
+  * @brief  注册按键事件回调 (在主循环上下文中执行)
+  * @param  cb 回调函数，NULL 表示只更新 keyState
+  * @retval None
+  */
+void KEY_SetEventCallback(void (*cb)(const KeyEvent *evt)) {
+    keyEventCallback = cb;
+}
+
+/**
+  * @brief  设置按键的保持时间
+  * @note   保持判定在扫描中断中完成，按下后经过 ms 毫秒 (按扫描周期取整) 上报 KEY_EVT_HOLD，
+  *         事件驱动的上层 (如 tapHold) 无需轮询 millis()
+  * @param  i  按键索引 (0-4)
+  * @param  ms 保持时间，0 表示不上报
+  * @retval None
+  */
+void KEY_SetHoldTime(uint8_t i, uint16_t ms) {
+    if (i >= 5) {
+        return;
+    }
+    portENTER_CRITICAL(&keyMux);
+    keyHoldUs[i] = (uint32_t)ms * 1000;
+    portEXIT_CRITICAL(&keyMux);
+}
+
+/**
+  * @brief  设置一次性到期时间
+  * @note   与保持事件一样由扫描中断判定，上层 (如 combo 窗口) 无需轮询 millis()；
+  *         以事件时间戳为基准，主循环处理事件的延迟不会拉长窗口。重复调用以最后一次为准
+  * @param  time 到期时间 (esp_timer_get_time() 低 32 位, us)
+  * @retval None
+  */
+void KEY_SetDeadline(uint32_t time) {
+    portENTER_CRITICAL(&keyMux);
+    keyDeadline = time;
+    keyDeadlineArmed = true;
+    portEXIT_CRITICAL(&keyMux);
+}
+
+/**
+  * @brief  取消到期时间
+  * @retval None
+  */
+void KEY_CancelDeadline() {
+    portENTER_CRITICAL(&keyMux);
+    keyDeadlineArmed = false;
+    portEXIT_CRITICAL(&keyMux);
+}
+
 /**
   * @brief  初始化按键 GPIO
   * @param  None
@@ -53,54 +208,275 @@ char release[8] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
 void KEY_Init() {
     for (int i = 0; i < 5; i++) {
         pinMode(KEY_PINS[i], INPUT);
+        keyPinMask[i] = 1UL << KEY_PINS[i];
+    }
+    KEY_SetDebounce(KEY_DEBOUNCE_MS);
+    KEY_SetInputMode(KEY_INPUT_IRQ);
+}
+
+/**
+  * @brief  设置去抖窗口
+  * @note   垂直计数器需要连续 4 次采样一致才翻转状态，
+  *         窗口按扫描周期 (KEY_SCAN_PERIOD_US) 换算为采样间隔，取最接近的值
+  * @param  ms 状态需要稳定的时间 (ms)
+  * @retval None
+  */
+void KEY_SetDebounce(uint8_t ms) {
+    uint32_t samplePeriodUs = ((uint32_t)ms * 1000 + 2) / 4;
+    uint32_t divider = (samplePeriodUs + KEY_SCAN_PERIOD_US / 2) / KEY_SCAN_PERIOD_US;
+
+    if (divider == 0) {
+        divider = 1;
+    } else if (divider > 255) {
+        divider = 255;
     }
+    scanDivider = divider;
+    lockoutUs = (uint32_t)ms * 1000;
 }
 
 /**
-  * @brief  检测按键状态 (轮询模式)
-  * @note   包含去抖动逻辑 (5ms) 和长按时间判定
+  * @brief  按键边沿中断服务函数 (KEY_INPUT_IRQ 模式)
+  * @note   首个边沿立即翻转稳定状态并打上时间戳，随后进入锁定期，
+  *         锁定期内的抖动被忽略；锁定期结束后由 KEY_Scan 按常规去抖校验，
+  *         若电平与上报状态不符 (毛刺) 则再经 4 次采样纠正
+  * @param  arg 按键索引 (0-4)
+  * @retval None
+  */
+static void IRAM_ATTR KEY_EdgeISR(void *arg) {
+    uint8_t i = (uint8_t)(uintptr_t)arg;
+    uint8_t bit = 1 << i;
+    int64_t now = esp_timer_get_time();
+    bool level = (REG_READ(GPIO_IN_REG) & keyPinMask[i]) == 0; // 低电平有效
+
+    portENTER_CRITICAL_ISR(&keyMux);
+    if (!(keyLockout & bit) && level != ((keyStable & bit) != 0)) {
+        keyStable ^= bit;
+        keyHoldFired &= ~bit;
+        if (level) {
+            keyPressAcc |= bit;
+        } else {
+            keyReleaseAcc |= bit;
+        }
+        KEY_PushEvent(level ? KEY_EVT_PRESS : KEY_EVT_RELEASE, i, (uint32_t)now);
+        keyEdgeTime[i] = now;
+        keyLockout |= bit;
+        keyCnt0 &= ~bit;
+        keyCnt1 &= ~bit;
+    }
+    portEXIT_CRITICAL_ISR(&keyMux);
+}
+
+/**
+  * @brief  切换按键输入模式
+  * @param  mode KEY_INPUT_SCAN 或 KEY_INPUT_IRQ
+  * @retval None
+  */
+void KEY_SetInputMode(KEY_InputMode mode) {
+    if (mode == inputMode) {
+        return;
+    }
+    for (int i = 0; i < 5; i++) {
+        if (mode == KEY_INPUT_IRQ) {
+            attachInterruptArg(KEY_PINS[i], KEY_EdgeISR, (void *)(uintptr_t)i, CHANGE);
+        } else {
+            detachInterrupt(KEY_PINS[i]);
+        }
+    }
+    portENTER_CRITICAL(&keyMux);
+    inputMode = mode;
+    keyLockout = 0;
+    portEXIT_CRITICAL(&keyMux);
+}
+
+/**
+  * @brief  获取按键最近一次状态翻转的时间戳
+  * @param  i 按键索引 (0-4)
+  * @retval esp_timer_get_time() 时间 (us)
+  */
+int64_t KEY_GetEdgeTime(uint8_t i) {
+    int64_t t;
+
+    portENTER_CRITICAL(&keyMux);
+    t = keyEdgeTime[i];
+    portEXIT_CRITICAL(&keyMux);
+    return t;
+}
+
+/**
+  * @brief  按键扫描与去抖 (在定时器中断中调用)
+  * @note   每次采样只读取一次 GPIO_IN 寄存器，所有按键用位运算同时去抖：
+  *         对每个与稳定状态不同的按键，2 位垂直计数器加一，连续 4 次不同才翻转；
+  *         采样与稳定状态一致则计数器清零。耗时固定，与按键数量无关。
+  * @note   KEY_INPUT_IRQ 模式下作为兜底：跳过锁定期内的按键，并校验/补回中断上报的状态
+  * @param  None
+  * @retval None
+  */
+void IRAM_ATTR KEY_Scan() {
+    uint32_t in;
+    uint8_t raw = 0;
+    uint8_t delta, toggle;
+
+    int64_t now;
+
+    if (++scanCnt < scanDivider) {
+        return;
+    }
+    scanCnt = 0;
+    now = esp_timer_get_time();
+
+    // 单次寄存器快照，按键低电平有效
+    in = ~REG_READ(GPIO_IN_REG);
+    for (int i = 0; i < 5; i++) {
+        if (in & keyPinMask[i]) {
+            raw |= (1 << i);
+        }
+    }
+
+    portENTER_CRITICAL_ISR(&keyMux);
+    // 释放锁定期已结束的按键
+    if (keyLockout) {
+        for (int i = 0; i < 5; i++) {
+            if ((keyLockout & (1 << i)) && now - keyEdgeTime[i] >= lockoutUs) {
+                keyLockout &= ~(1 << i);
+            }
+        }
+    }
+
+    delta = (raw ^ keyStable) & ~keyLockout;
+    keyCnt1 = (keyCnt1 ^ keyCnt0) & delta;
+    keyCnt0 = ~keyCnt0 & delta;
+    toggle = delta & ~(keyCnt0 | keyCnt1);
+
+    if (toggle) {
+        keyStable ^= toggle;
+        keyHoldFired &= ~toggle;
+        keyPressAcc |= toggle & keyStable;
+        keyReleaseAcc |= toggle & ~keyStable;
+        for (int i = 0; i < 5; i++) {
+            if (toggle & (1 << i)) {
+                KEY_PushEvent((keyStable & (1 << i)) ? KEY_EVT_PRESS : KEY_EVT_RELEASE, i, (uint32_t)now);
+                keyEdgeTime[i] = now;
+            }
+        }
+    }
+
+    // 保持判定：按下持续该键的保持时间后上报一次
+    if (keyStable & ~keyHoldFired) {
+        for (int i = 0; i < 5; i++) {
+            uint8_t bit = 1 << i;
+            if ((keyStable & ~keyHoldFired & bit) && keyHoldUs[i] && now - keyEdgeTime[i] >= (int64_t)keyHoldUs[i]) {
+                keyHoldFired |= bit;
+                KEY_PushEvent(KEY_EVT_HOLD, i, (uint32_t)now);
+            }
+        }
+    }
+
+    if (keyDeadlineArmed && (int32_t)((uint32_t)now - keyDeadline) >= 0) {
+        keyDeadlineArmed = false;
+        KEY_PushEvent(KEY_EVT_TIMEOUT, 0, (uint32_t)now);
+    }
+    portEXIT_CRITICAL_ISR(&keyMux);
+}
+
+/**
+  * @brief  更新按键状态 (主循环调用)
+  * @note   先在临界区内取走中断累计的按下/释放沿集合并记下队列写指针，再只消费到该位置为止的事件，
+  *         使边沿集合与本次处理的事件一一对应：集合刷新 keyState 的边沿，按下/释放事件刷新按下状态，
+  *         按下/释放/保持/超时事件转交按键事件回调 (combo -> tapHold 引擎)，TICK 事件分发给 tick 回调。不阻塞
   * @param  None
   * @retval bool 是否有任意按键处于按下状态
   */
 bool KEY_Update() {
-    bool isAnyKeyPressed = false;
+    KeyEvent evt;
+    uint8_t head;
 
-    // 循环处理 5 个按键
+    portENTER_CRITICAL(&keyMux);
+    head = keyEvtHead;
+    keyPressEdges = keyPressAcc;
+    keyReleaseEdges = keyReleaseAcc;
+    keyPressAcc = 0;
+    keyReleaseAcc = 0;
+    portEXIT_CRITICAL(&keyMux);
+
+    // 边沿只在本次调用内有效
     for (int i = 0; i < 5; i++) {
-        
-        // --- 1. 物理按键去抖动处理 ---
-        if (pressed(KEY_PINS[i])) {
-            delay(5); // 简单的阻塞式消抖 (注意：多键同时按可能会叠加延时，但在宏键盘应用中可接受)
-            if (pressed(KEY_PINS[i])) {
-                isAnyKeyPressed = true;
-                keyState[i].isPressed = true;
-            } else {
-                // 可能是干扰信号
-                keyState[i].isPressed = false; 
+        keyState[i].pressEdge = (keyPressEdges >> i) & 1;
+        keyState[i].releaseEdge = (keyReleaseEdges >> i) & 1;
+    }
+
+    while (keyEvtTail != head && KEY_PopEvent(&evt)) {
+        KeyState *k = &keyState[evt.key];
+
+        switch (evt.type) {
+        case KEY_EVT_PRESS:
+            k->isPressed = true;
+            break;
+
+        case KEY_EVT_RELEASE:
+            k->isPressed = false;
+            break;
+
+        case KEY_EVT_HOLD:
+        case KEY_EVT_TIMEOUT:
+            break;
+
+        case KEY_EVT_TICK:
+            if (keyTickCallback) {
+                keyTickCallback();
             }
-        } else {
-            keyState[i].isPressed = false;
+            continue;
         }
 
-        // --- 2. 长按逻辑检测  ---
-        if (keyState[i].isPressed) {
-            // 如果是刚按下，记录起始时间
-            if (keyPressStartTime[i] == 0) {
-                keyPressStartTime[i] = millis();
-            } 
-            // 如果按下时间超过阈值 (LONG_PRESS_TIME 需在头文件定义)
-            else if (millis() - keyPressStartTime[i] > LONG_PRESS_TIME) {
-                keyLongPressed[i] = true; // 置位长按标志
-                keyPressStartTime[i] = 0; // 重置计时器，防止重复触发 (实现单次长按触发)
-                
-                // 如果需要长按连发功能，这里可以不重置为0，而是重置为 millis() - (LONG_PRESS_TIME - REPEAT_INTERVAL)
-            }
-        } else {
-            // 按键抬起，重置计时器
-            keyPressStartTime[i] = 0;
-            // 注意：keyLongPressed[i] 标志位通常需要在消费端(sys.cpp)处理完逻辑后手动清除
+        if (keyEventCallback) {
+            keyEventCallback(&evt);
         }
     }
 
-    return isAnyKeyPressed;
-}
\ No newline at end of file
+    return keyStable != 0;
+}
+
+/**
+  * @brief  清除本次 KEY_Update 的边沿 (keyState 与边沿集合)
+  * @note   模式切换时调用，触发切换的按键边沿不交给新模式
+  * @retval None
+  */
+void KEY_ClearEdges() {
+    for (int i = 0; i < 5; i++) {
+        keyState[i].pressEdge = false;
+        keyState[i].releaseEdge = false;
+    }
+    keyPressEdges = 0;
+    keyReleaseEdges = 0;
+}
+
+/**
+  * @brief  获取去抖后的按住集合
+  * @retval 位掩码，bit i 对应 Key i+1
+  */
+uint8_t KEY_GetHeldMask() {
+    return keyStable;
+}
+
+/**
+  * @brief  获取本次 KEY_Update 取走的按下集合 (changed & state)
+  * @retval 位掩码，bit i 对应 Key i+1
+  */
+uint8_t KEY_GetPressedMask() {
+    return keyPressEdges;
+}
+
+/**
+  * @brief  获取本次 KEY_Update 取走的释放集合 (changed & ~state)
+  * @retval 位掩码，bit i 对应 Key i+1
+  */
+uint8_t KEY_GetReleasedMask() {
+    return keyReleaseEdges;
+}
+
+/**
+  * @brief  获取本次 KEY_Update 取走的变化集合 (按下或释放过的键)
+  * @retval 位掩码，bit i 对应 Key i+1
+  */
+uint8_t KEY_GetChangedMask() {
+    return keyPressEdges | keyReleaseEdges;
+}
@@ -0,0 +1,213 @@
+/**
+  ******************************************************************************
+  * @file    keymap.c
+  * @brief   键位层 (layer) 栈
+  * @note    激活层用 16 位掩码表示，每个按键预先计算一个"非透明层"掩码，
+  *          查找时两者相与后取最高位 (clz)，耗时固定，与层数无关。
+  *          切换预设只交换层指针并重算掩码，切换层只改掩码，下一个按键事件即生效
+  ******************************************************************************
+  */
+
+#include "keymap.h"
+
+// 各层键位表，kmLayer[0] 为基础层
+static const uint8_t (*kmLayer[KM_MAX_LAYERS])[KM_ENTRY_LEN];
+static uint8_t kmLayerCount = 0;
+
+// 以下掩码：bit n 对应层 n
+static uint16_t kmOpaque[KM_KEY_COUNT];   // 各按键的非透明层 (bit 0 始终置位)
+static uint16_t kmActive = 0x0001;        // 激活层
+
+// 各按键按下时查到的键位，释放时使用
+static const uint8_t *kmDown[KM_KEY_COUNT];
+
+// one-shot 层状态
+static uint8_t kmOneShot = 0;             // 等待中的 one-shot 层，0 表示无
+static uint8_t kmOneShotKey = 0;          // 触发 one-shot 的按键
+static bool kmOneShotHeld = false;        // 触发键仍按住
+static bool kmOneShotUsed = false;        // 按住期间已有其他按键使用该层
+
+/**
+  * @brief  切换键位表
+  * @note   透明键位在此时登记到 kmOpaque，查找时不再逐层判断
+  * @param  base   基础层
+  * @param  layers 上层数组，可为 NULL
+  * @param  count  上层数量
+  * @retval None
+  */
+void KM_SetKeymap(const KM_Layer base, const KM_Layer *layers, uint8_t count) {
+    if (!layers) {
+        count = 0;
+    } else if (count > KM_MAX_LAYERS - 1) {
+        count = KM_MAX_LAYERS - 1;
+    }
+
+    kmLayer[0] = base;
+    for (uint8_t n = 0; n < count; n++) {
+        kmLayer[n + 1] = layers[n];
+    }
+    kmLayerCount = count + 1;
+
+    for (int i = 0; i < KM_KEY_COUNT; i++) {
+        kmOpaque[i] = 0x0001;
+        for (uint8_t n = 1; n < kmLayerCount; n++) {
+            if (kmLayer[n][i][1] != KM_TAG_TRNS) {
+                kmOpaque[i] |= 1 << n;
+            }
+        }
+    }
+
+    // 新键位表从基础层开始；已按下按键保存的键位指向原表，释放时仍然有效
+    kmActive = 0x0001;
+    kmOneShot = 0;
+}
+
+/**
+  * @brief  查找按键在当前激活层中的键位
+  * @param  key 按键索引 (0-4)
+  * @retval 8 字节键位
+  */
+const uint8_t *KM_Resolve(uint8_t key) {
+    uint16_t m = kmActive & kmOpaque[key];
+
+    return kmLayer[31 - __builtin_clz(m)][key];
+}
+
+/**
+  * @brief  按键按下
+  * @param  key 按键索引 (0-4)
+  * @retval 需要发送的报文或宏键位，层操作与基础层的透明键位返回 NULL
+  */
+const uint8_t *KM_KeyDown(uint8_t key) {
+    const uint8_t *e;
+
+    if (key >= KM_KEY_COUNT || kmLayerCount == 0) {
+        return NULL;
+    }
+    e = KM_Resolve(key);
+    kmDown[key] = e;
+
+    switch (e[1]) {
+    case KM_TAG_KEY:
+    case KM_TAG_MACRO:
+        // one-shot 层只作用于一个按键：触发键已松开则立即关闭，仍按住则在其松开时关闭
+        if (kmOneShot) {
+            if (kmOneShotHeld) {
+                kmOneShotUsed = true;
+            } else {
+                KM_LayerOff(kmOneShot);
+                kmOneShot = 0;
+            }
+        }
+        return e;
+
+    case KM_TAG_MO:
+        KM_LayerOn(e[2]);
+        break;
+
+    case KM_TAG_TG:
+        KM_LayerToggle(e[2]);
+        break;
+
+    case KM_TAG_OSL:
+        if (kmOneShot && kmOneShot != e[2]) {
+            KM_LayerOff(kmOneShot);
+        }
+        KM_LayerOn(e[2]);
+        kmOneShot = e[2];
+        kmOneShotKey = key;
+        kmOneShotHeld = true;
+        kmOneShotUsed = false;
+        break;
+
+    default:
+        break;
+    }
+    return NULL;
+}
+
+/**
+  * @brief  按键释放
+  * @param  key 按键索引 (0-4)
+  * @retval bool 按下时是否发送了报文
+  */
+bool KM_KeyUp(uint8_t key) {
+    const uint8_t *e;
+
+    if (key >= KM_KEY_COUNT || !kmDown[key]) {
+        return false;
+    }
+    e = kmDown[key];
+    kmDown[key] = NULL;
+
+    switch (e[1]) {
+    case KM_TAG_KEY:
+        return true;
+
+    case KM_TAG_MO:
+        KM_LayerOff(e[2]);
+        break;
+
+    case KM_TAG_OSL:
+        if (kmOneShot == e[2] && kmOneShotKey == key) {
+            kmOneShotHeld = false;
+            if (kmOneShotUsed) {
+                KM_LayerOff(kmOneShot);
+                kmOneShot = 0;
+            }
+        }
+        break;
+
+    default:
+        break;
+    }
+    return false;
+}
+
+/**
+  * @brief  激活一层
+  */
+void KM_LayerOn(uint8_t layer) {
+    if (layer < KM_MAX_LAYERS) {
+        kmActive |= 1 << layer;
+    }
+}
+
+/**
+  * @brief  关闭一层 (层 0 始终激活)
+  */
+void KM_LayerOff(uint8_t layer) {
+    if (layer > 0 && layer < KM_MAX_LAYERS) {
+        kmActive &= ~(1 << layer);
+    }
+}
+
+/**
+  * @brief  切换一层
+  */
+void KM_LayerToggle(uint8_t layer) {
+    if (layer > 0 && layer < KM_MAX_LAYERS) {
+        kmActive ^= 1 << layer;
+    }
+}
+
+/**
+  * @brief  获取激活层掩码
+  */
+uint16_t KM_GetLayerMask() {
+    return kmActive;
+}
+
+/**
+  * @brief  设置激活层掩码 (层 0 始终激活)
+  */
+void KM_SetLayerMask(uint16_t mask) {
+    kmActive = mask | 0x0001;
+}
+
+/**
+  * @brief  获取最高的激活层
+  */
+uint8_t KM_GetTopLayer() {
+    return 31 - __builtin_clz(kmActive);
+}
@@ -0,0 +1,317 @@
+/**
+  ******************************************************************************
+  * @file    macro.c
+  * @brief   非阻塞宏引擎
+  * @note    宏在主循环中逐条执行，每次只输出调用方给出的配额 (发送队列空位) 以内的报文，
+  *          报文由 Hid2Ble 发送任务按连接间隔的配额发出，因此宏以链路允许的最快速度输出且不阻塞 loop()。
+  *          延时指令只记录计划时间，到期后的第一次 MAC_Update 继续执行
+  ******************************************************************************
+  */
+
+#include "macro.h"
+#include "HidAscii.h"
+
+#define MAC_REPORT_LEN 8
+
+static const uint8_t *const *macTable = NULL;
+static uint8_t macCount = 0;
+static MAC_Output macOut = NULL;
+
+// 执行状态
+static const uint8_t *macPc = NULL;       // 下一条指令 (文本中为下一个字符)，NULL 表示空闲
+static bool macInText = false;            // 正在执行文本指令
+static bool macFresh = false;             // 刚启动，尚未执行第一条指令
+static uint8_t macReport[MAC_REPORT_LEN]; // 宏当前按住的键
+static bool macUpPending = false;         // 轻按的释放报文待输出
+static uint8_t macUpMods, macUpCode;
+static uint32_t macDue = 0;               // 延时指令设定的到期时间 (us)
+static bool macWaiting = false;           // 正在等待 macDue，到期后的第一条指令计入执行误差
+
+// 本次执行的计时
+static uint32_t macStartTime = 0;
+static uint32_t macDelayUs = 0;           // 延时指令的计划等待时间总和
+static uint32_t macRunReports = 0;
+
+static uint64_t macErrSum = 0;
+static uint32_t macErrCount = 0;
+static MAC_Stats macStats = {0, 0, 0, 0, 0, 0, 0, 0};
+
+/**
+  * @brief  输出宏当前报文 (全空时输出 NULL)
+  */
+static void MAC_Emit(void) {
+    bool empty = macReport[0] == 0;
+
+    for (int i = 2; i < MAC_REPORT_LEN && empty; i++) {
+        empty = macReport[i] == 0;
+    }
+    if (macOut) {
+        macOut(empty ? NULL : macReport);
+    }
+    macStats.reports++;
+    macRunReports++;
+}
+
+/**
+  * @brief  加入修饰键与键码 (已存在或槽位已满时只加修饰键)
+  */
+static void MAC_AddKey(uint8_t mods, uint8_t code) {
+    int slot = -1;
+
+    macReport[0] |= mods;
+    if (code == 0) {
+        return;
+    }
+    for (int i = 2; i < MAC_REPORT_LEN; i++) {
+        if (macReport[i] == code) {
+            return;
+        }
+        if (macReport[i] == 0 && slot < 0) {
+            slot = i;
+        }
+    }
+    if (slot >= 0) {
+        macReport[slot] = code;
+    }
+}
+
+/**
+  * @brief  移除修饰键与键码，其余键码前移保持按下顺序
+  */
+static void MAC_RemoveKey(uint8_t mods, uint8_t code) {
+    int n = 2;
+
+    macReport[0] &= ~mods;
+    for (int i = 2; i < MAC_REPORT_LEN; i++) {
+        if (macReport[i] != 0 && macReport[i] != code) {
+            macReport[n++] = macReport[i];
+        }
+    }
+    while (n < MAC_REPORT_LEN) {
+        macReport[n++] = 0;
+    }
+}
+
+/**
+  * @brief  记录延时到期后第一条指令的执行误差 (实际执行时间 - 到期时间)
+  * @note   连续执行的指令没有计划时间，不参与统计
+  */
+static void MAC_NoteStep(uint32_t now) {
+    uint32_t err = now - macDue;
+
+    macErrSum += err;
+    macErrCount++;
+    macStats.stepErrAvgUs = (uint32_t)(macErrSum / macErrCount);
+    if (err > macStats.stepErrMaxUs) {
+        macStats.stepErrMaxUs = err;
+    }
+}
+
+/**
+  * @brief  下一条指令是否会输出报文 (需要占用配额)
+  */
+static bool MAC_NeedsReport(uint8_t op) {
+    switch (op) {
+    case MAC_OP_PRESS:
+    case MAC_OP_RELEASE:
+    case MAC_OP_TAP:
+        return true;
+    case MAC_OP_DELAY:
+        return macUpPending;
+    case MAC_OP_TEXT:
+        return macUpPending || !macInText || *macPc != 0;
+    default:
+        return macUpPending || macReport[0] || macReport[2];
+    }
+}
+
+/**
+  * @brief  宏执行完成，计算吞吐
+  */
+static void MAC_Finish(uint32_t now) {
+    uint32_t activeUs = now - macStartTime - macDelayUs;
+
+    if (activeUs == 0 || activeUs > now - macStartTime) {
+        activeUs = 1; // 同一次 MAC_Update 内完成 (或延时提前结束)
+    }
+    macStats.rate = (uint32_t)((uint64_t)macRunReports * 1000000 / activeUs);
+    if (macStats.rate > macStats.peakRate) {
+        macStats.peakRate = macStats.rate;
+    }
+    macStats.runs++;
+    macPc = NULL;
+}
+
+/**
+  * @brief  初始化宏引擎
+  * @param  out 报文输出回调
+  * @retval None
+  */
+void MAC_Init(MAC_Output out) {
+    macOut = out;
+    macPc = NULL;
+}
+
+/**
+  * @brief  设置宏表
+  * @param  macros 字节码指针数组
+  * @param  count  宏数
+  * @retval None
+  */
+void MAC_SetTable(const uint8_t *const *macros, uint8_t count) {
+    macTable = macros;
+    macCount = count > MAC_MAX_MACROS ? MAC_MAX_MACROS : count;
+}
+
+/**
+  * @brief  开始执行一个宏
+  * @note   同一时刻只执行一个宏，执行中再次启动会被忽略 (计入 busy)
+  * @param  index 宏序号
+  * @retval bool 是否已开始
+  */
+bool MAC_Start(uint8_t index) {
+    if (!macTable || index >= macCount || !macTable[index]) {
+        return false;
+    }
+    if (macPc) {
+        macStats.busy++;
+        return false;
+    }
+
+    memset(macReport, 0, sizeof(macReport));
+    macPc = macTable[index];
+    macInText = false;
+    macUpPending = false;
+    macFresh = true;
+    macWaiting = false;
+    macDelayUs = 0;
+    macRunReports = 0;
+    return true;
+}
+
+/**
+  * @brief  中止正在执行的宏
+  * @retval None
+  */
+void MAC_Stop() {
+    if (macPc) {
+        macStats.aborted++;
+        macPc = NULL;
+    }
+}
+
+/**
+  * @brief  推进宏执行
+  * @note   不输出报文的指令 (延时、结束、不可输入的字符) 不占用配额
+  * @param  now    当前时间 (us)
+  * @param  budget 本次最多可输出的报文数
+  * @retval 本次输出的报文数
+  */
+uint8_t MAC_Update(uint32_t now, uint8_t budget) {
+    uint8_t sent = 0;
+
+    if (macPc && macFresh) {
+        macFresh = false;
+        macStartTime = now;
+    }
+
+    while (macPc && (!macWaiting || (int32_t)(now - macDue) >= 0)) {
+        uint8_t op = macInText ? MAC_OP_TEXT : *macPc;
+
+        if (sent >= budget && MAC_NeedsReport(op)) {
+            break;
+        }
+        if (macWaiting) {
+            macWaiting = false;
+            MAC_NoteStep(now);
+        }
+
+        // 轻按的释放报文先于下一条指令
+        if (macUpPending) {
+            macUpPending = false;
+            MAC_RemoveKey(macUpMods, macUpCode);
+            MAC_Emit();
+            sent++;
+            continue;
+        }
+
+        switch (op) {
+        case MAC_OP_PRESS:
+            MAC_AddKey(macPc[1], macPc[2]);
+            macPc += 3;
+            MAC_Emit();
+            sent++;
+            break;
+
+        case MAC_OP_RELEASE:
+            MAC_RemoveKey(macPc[1], macPc[2]);
+            macPc += 3;
+            MAC_Emit();
+            sent++;
+            break;
+
+        case MAC_OP_TAP:
+            MAC_AddKey(macPc[1], macPc[2]);
+            macUpMods = macPc[1];
+            macUpCode = macPc[2];
+            macUpPending = true;
+            macPc += 3;
+            MAC_Emit();
+            sent++;
+            break;
+
+        case MAC_OP_DELAY: {
+            uint32_t us = (uint32_t)(macPc[1] | (macPc[2] << 8)) * 1000;
+            macPc += 3;
+            macDue = now + us;
+            macWaiting = true;
+            macDelayUs += us;
+            break;
+        }
+
+        case MAC_OP_TEXT:
+            if (!macInText) {
+                macInText = true;
+                macPc++;
+            }
+            if (*macPc == 0) {
+                macInText = false;
+                macPc++;
+            } else if (hidAsciiLookup(*macPc++, &macUpMods, &macUpCode)) {
+                MAC_AddKey(macUpMods, macUpCode);
+                macUpPending = true;
+                MAC_Emit();
+                sent++;
+            }
+            break;
+
+        default:
+            // 结束：释放宏仍按住的键后完成
+            if (macReport[0] || macReport[2]) {
+                memset(macReport, 0, sizeof(macReport));
+                MAC_Emit();
+                sent++;
+            }
+            MAC_Finish(now);
+            break;
+        }
+    }
+
+    return sent;
+}
+
+/**
+  * @brief  是否有宏在执行
+  */
+bool MAC_IsRunning() {
+    return macPc != NULL;
+}
+
+/**
+  * @brief  获取宏引擎统计
+  * @param  stats 输出统计
+  * @retval None
+  */
+void MAC_GetStats(MAC_Stats *stats) {
+    *stats = macStats;
+}
@@ -34,6 +34,8 @@ void setup()
 {
 
     KEY_Init();
+    KEY_SetTickCallback(SYS_TimerTick); // 定时器秒计时事件在主循环中处理
+    SYS_KeyActionInit();          // 按键轻按/按住动作绑定 (按住切换模式)
     SYS_LoadPreset();             // 从 NVS 或存储加载用户配置
     SYS_ApplyPreset(currentPreset); // 应用当前配置
 
@@ -68,7 +70,7 @@ void setup()
     // 80分频 -> 80MHz / 80 = 1MHz (1us 计数一次)
     hw_timer_t *timer = timerBegin(0, 80, true);
     timerAttachInterrupt(timer, &KEY_Detect, true);
-    timerAlarmWrite(timer, 10000, true); // 10000 * 1us = 10ms 触发一次
+    timerAlarmWrite(timer, KEY_SCAN_PERIOD_US, true); // 1000 * 1us = 1ms 触发一次 (1kHz)
     timerAlarmEnable(timer);
 
     /* 定时器 1: 用于电池电量同步 (低频) */
@@ -93,6 +95,7 @@ void loop()
 
     if (active) {
         UIManager::onActivity();
+        keybrick.onActivity(); // 按键活跃时使用低延迟连接参数
     }
 
     // 低电量强制低亮度保护
@@ -105,9 +108,10 @@ void loop()
         UIManager::setLowBattery(false);
     }
 
-    SYS_ModeSwitch(); // 扫描是否触发了“模式切换”组合键
-
     // --- 2. BLE 连接管理 ---
+    keybrick.updateConnProfile(); // 连接后请求低延迟参数，空闲超时后切换到低功耗参数
+    keybrick.updateReconnect();   // 断开后定向广播重连，逐步退到快速/慢速广播
+
     if (keybrick.isConnected())
     {
         sysStatus.bleConnected = true;
@@ -116,22 +120,22 @@ void loop()
         {
             KEY_Send();
         }
+        SYS_MacroUpdate(); // 宏按发送队列空位逐步输出，不阻塞
+        SYS_TextUpdate();  // 文本输入结束后重发当前按键状态
     }
     else
     {
-        sysStatus.bleConnected = false;
-        // TODO: 此处可添加自动重连逻辑 (Advertising Resume)
+        sysStatus.bleConnected = false; // 重连广播由 updateReconnect() 负责
     }
 
     // --- 3. 模式状态机处理 (Mode Handling) ---
     switch (currentMode)
     {
     case MODE_NORMAL:
-        // 状态切换保护：如果是刚进入此模式，清空屏幕并发送一次 Release 防止卡键
+        // 状态切换保护：如果是刚进入此模式，发送一次 Release 防止卡键 (清屏由 UIManager 负责)
         if (!enableKey)
         {
-            OLED_Clear();
-            keybrick.send2Ble(release);
+            KEY_ReleaseAll();
             UIManager::resetScroll();
         }
         enableKey = true; // 允许键盘发送功能
@@ -141,8 +145,7 @@ void loop()
     case MODE_TIMER_SET:
         if (enableKey)
         {
-            OLED_Clear();
-            keybrick.send2Ble(release);
+            KEY_ReleaseAll();
         }
         enableKey = false; // 此时按键用于调整时间，禁止发送 HID 键值
         TIMER_Set();       // 进入时间设置 UI 逻辑
@@ -151,8 +154,7 @@ void loop()
     case MODE_METRONOME:
         if (enableKey)
         {
-            OLED_Clear();
-            keybrick.send2Ble(release);
+            KEY_ReleaseAll();
         }
         enableKey = false;
         METRONOME_Set(); // 进入节拍器设置 UI 逻辑
@@ -161,13 +163,21 @@ void loop()
     case MODE_KEY_CONFIG:
         if (enableKey)
         {
-            OLED_Clear();
-            keybrick.send2Ble(release);
+            KEY_ReleaseAll();
             UIManager::resetScroll(); 
         }
         enableKey = false;
         SYS_KeyConfig(); // 进入按键预设配置 UI 逻辑
         break;
+
+    case MODE_HOST_SELECT:
+        if (enableKey)
+        {
+            KEY_ReleaseAll();
+        }
+        enableKey = false;
+        SYS_HostSelect(); // 进入主机槽位选择 UI 逻辑
+        break;
     }
 
     // --- 4. 后台任务与 UI 刷新 ---
@@ -1,85 +1,430 @@
 #include "oled.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
 
-uint8_t OLED_HEIGHT = 64;
+uint8_t OLED_HEIGHT = OLED_MAX_HEIGHT;
 uint8_t OLED_IIC_BUS = 0;
 
+// 显存 (GRAM)：所有 OLED_Print* 只写入这里，由 OLED_Flush() 统一刷到屏幕
+// 排列方式与 SSD1306 GDDRAM 一致：[页][列]，每字节纵向 8 个像素
+static uint8_t OLED_GRAM[OLED_PAGES][OLED_WIDTH];
+
+// 每页的脏区列范围 [x1, x2]，x1 > x2 表示该页无需刷新
+static uint8_t OLED_DirtyX1[OLED_PAGES];
+static uint8_t OLED_DirtyX2[OLED_PAGES];
+
+// 刷新窗口：控制器工作在水平寻址模式，一个窗口只需一次定位 + 一次连续写入
+typedef struct {
+    uint8_t x1, x2; // 列范围 (含)
+    uint8_t p1, p2; // 页范围 (含)
+    uint16_t offset; // 窗口数据在发送缓冲区中的起始位置
+    bool failed;     // 发送失败 (刷新任务写入)，下次提交前重新标记为脏
+} OLED_Window;
+
+// 发送缓冲区：OLED_Flush() 把脏区按窗口顺序线性快照到这里，由刷新任务在后台写到屏幕
+// 主循环可以在发送期间继续修改 GRAM，互不干扰
+static uint8_t OLED_TxBuf[OLED_PAGES * OLED_WIDTH];
+static OLED_Window OLED_TxWin[OLED_PAGES];
+static uint8_t OLED_TxWinCount = 0;
+static volatile bool OLED_TxBusy = false;
+
+// 一个窗口的额外总线开销 (字节)：定位命令传输 (地址+控制+6 条命令) + 数据传输的地址和控制字节
+#define OLED_WINDOW_COST 10
+
+// 控制命令包 (亮度/开关屏等)，整包入队，保证多字节命令不被拆开
+typedef struct {
+    uint8_t len;
+    uint8_t cmds[OLED_CMD_MAX_LEN];
+} OLED_CmdPacket;
+
+static TaskHandle_t OLED_FlushTaskHandle = NULL;
+static QueueHandle_t OLED_CmdQueue = NULL;
+static void (*OLED_FlushDoneCb)(void) = NULL;
+
+// 控制器状态影子：记录最近一次写入控制器的设置，与之相同的命令不再发送
+// contrast/displayOn 在调用方 (主循环) 更新，窗口只在刷新任务中更新
+// 每次都完整写满窗口，写完后控制器指针自动回到窗口起点，因此窗口相同即无需重新定位
+typedef struct {
+    uint8_t contrast;
+    bool displayOn;
+    uint8_t addrMode; // 0x00 水平, 0x01 垂直, 0x02 页寻址
+    uint8_t colStart; // OLED_STATE_UNKNOWN 表示未知
+    uint8_t colEnd;
+    uint8_t pageStart;
+    uint8_t pageEnd;
+} OLED_CtrlState;
+
+#define OLED_STATE_UNKNOWN 0xFF
+
+static OLED_CtrlState OLED_State = {
+    .contrast = OLED_STATE_UNKNOWN,
+    .displayOn = false,
+    .addrMode = OLED_STATE_UNKNOWN, // MCU 复位时屏幕可能未掉电，寻址模式未知
+    .colStart = OLED_STATE_UNKNOWN,
+    .colEnd = OLED_STATE_UNKNOWN,
+    .pageStart = OLED_STATE_UNKNOWN,
+    .pageEnd = OLED_STATE_UNKNOWN
+};
+
+// 命令统计 (按命令字节计)，主循环与刷新任务都会累加，必须用原子加
+static volatile uint32_t OLED_CmdSent = 0;
+static volatile uint32_t OLED_CmdSuppressed = 0;
+
+#define OLED_STAT_ADD(stat, n) __atomic_fetch_add(&(stat), (n), __ATOMIC_RELAXED)
+
+/**
+  * @brief  获取当前屏幕高度对应的页数
+  * @retval 页数 (不超过 OLED_PAGES)
+  */
+static uint8_t OLED_PageCount() {
+    uint8_t pages = OLED_HEIGHT / 8;
+    if (pages > OLED_PAGES) {
+        pages = OLED_PAGES;
+    }
+    return pages;
+}
+
+/**
+  * @brief  向显存写入一个字节，并在内容变化时扩展该页的脏区
+  * @param  x: X坐标 (0-127)
+  * @param  y: 行坐标 (0-7)
+  * @param  data: 数据
+  * @retval None
+  */
+static void OLED_GRAM_Write(uint8_t x, uint8_t y, uint8_t data) {
+    if (x >= OLED_WIDTH || y >= OLED_PageCount()) {
+        return;
+    }
+    if (OLED_GRAM[y][x] == data) {
+        return; // 内容未变，不产生总线流量
+    }
+    OLED_GRAM[y][x] = data;
+
+    if (OLED_DirtyX1[y] > OLED_DirtyX2[y]) {
+        OLED_DirtyX1[y] = x;
+        OLED_DirtyX2[y] = x;
+    } else if (x < OLED_DirtyX1[y]) {
+        OLED_DirtyX1[y] = x;
+    } else if (x > OLED_DirtyX2[y]) {
+        OLED_DirtyX2[y] = x;
+    }
+}
+
+/**
+  * @brief  将整个显存标记为脏 (屏幕内容未知时使用，例如初始化后)
+  * @retval None
+  */
+static void OLED_InvalidateAll() {
+    uint8_t i;
+    for (i = 0; i < OLED_PAGES; i++) {
+        OLED_DirtyX1[i] = 0;
+        OLED_DirtyX2[i] = OLED_WIDTH - 1;
+    }
+}
+
+/**
+  * @brief  OLED 在一次传输中写入多条命令 (阻塞，直接操作总线)
+  * @param  cmds: 命令序列
+  * @param  len: 命令个数
+  * @retval 传输是否成功
+  */
+static bool OLED_WriteCommands(const uint8_t* cmds, uint8_t len) {
+    OLED_STAT_ADD(OLED_CmdSent, len);
+    return IIC_WriteBurst(OLED_IIC_BUS, OLED_IIC_ADDR, 0x00, cmds, len);
+}
+
+/**
+  * @brief  OLED 提交一组命令
+  * @note   刷新任务启动后命令整包入队由后台发送，调用方不等待总线；
+  * @note   队列已满时丢弃该命令包
+  * @param  cmds: 命令序列
+  * @param  len: 命令个数 (不超过 OLED_CMD_MAX_LEN)
+  * @retval 命令是否已发送或入队
+  */
+static bool OLED_QueueCommands(const uint8_t* cmds, uint8_t len) {
+    OLED_CmdPacket packet;
+
+    if (OLED_FlushTaskHandle == NULL) {
+        return OLED_WriteCommands(cmds, len);
+    }
+
+    if (len > OLED_CMD_MAX_LEN) {
+        len = OLED_CMD_MAX_LEN;
+    }
+    packet.len = len;
+    memcpy(packet.cmds, cmds, len);
+    if (xQueueSend(OLED_CmdQueue, &packet, 0) != pdTRUE) {
+        return false;
+    }
+    xTaskNotifyGive(OLED_FlushTaskHandle);
+    return true;
+}
+
 /**
   * @brief  OLED 写入命令
   * @param  command: 命令
   * @retval None
   */
 void OLED_WriteCommand(uint8_t command) {
-    IIC_Start(OLED_IIC_BUS);
-    IIC_SendByte(OLED_IIC_BUS, OLED_IIC_ADDR);
-    IIC_RcvACK(OLED_IIC_BUS);
-    IIC_SendByte(OLED_IIC_BUS, 0x00);
-    IIC_RcvACK(OLED_IIC_BUS);
-    IIC_SendByte(OLED_IIC_BUS, command);
-    IIC_RcvACK(OLED_IIC_BUS);
-    IIC_Stop(OLED_IIC_BUS);
+    OLED_QueueCommands(&command, 1);
 }
 
 /**
-  * @brief  OLED 向GDDRAM写入数据
-  * @param  Data: 数据
+  * @brief  OLED 向GDDRAM连续写入数据 (列地址自动递增)
+  * @param  data: 数据
+  * @param  len: 数据长度
+  * @retval 传输是否成功
+  */
+static bool OLED_WriteDataBurst(const uint8_t* data, uint16_t len) {
+    return IIC_WriteBurst(OLED_IIC_BUS, OLED_IIC_ADDR, 0x40, data, len);
+}
+
+
+/**
+  * @brief  OLED 设置写入窗口 (水平寻址模式，直接操作控制器，仅在发送帧时使用)
+  * @param  x1: 起始列 (0-127)
+  * @param  x2: 结束列 (x1-127)
+  * @param  p1: 起始页 (0-7)
+  * @param  p2: 结束页 (p1-7)
+  * @note   列/页范围与控制器当前窗口相同时省略对应命令；
+  * @note   传输失败时控制器窗口未知，下次重新定位
+  * @retval 定位命令是否发送成功
+  */
+static bool OLED_SetWindow(uint8_t x1, uint8_t x2, uint8_t p1, uint8_t p2) {
+    uint8_t cmds[6];
+    uint8_t len = 0;
+
+    if (OLED_State.colStart != x1 || OLED_State.colEnd != x2) {
+        cmds[len++] = 0x21; //设置列地址范围
+        cmds[len++] = x1;
+        cmds[len++] = x2;
+    } else {
+        OLED_STAT_ADD(OLED_CmdSuppressed, 3);
+    }
+    if (OLED_State.pageStart != p1 || OLED_State.pageEnd != p2) {
+        cmds[len++] = 0x22; //设置页地址范围
+        cmds[len++] = p1;
+        cmds[len++] = p2;
+    } else {
+        OLED_STAT_ADD(OLED_CmdSuppressed, 3);
+    }
+
+    if (len > 0 && !OLED_WriteCommands(cmds, len)) {
+        OLED_State.colStart = OLED_STATE_UNKNOWN;
+        OLED_State.pageStart = OLED_STATE_UNKNOWN;
+        return false;
+    }
+    OLED_State.colStart = x1;
+    OLED_State.colEnd = x2;
+    OLED_State.pageStart = p1;
+    OLED_State.pageEnd = p2;
+    return true;
+}
+
+/**
+  * @brief  将发送缓冲区中的一帧写到屏幕 (阻塞)
+  * @note   每个窗口一次定位 + 一次 I2C 连续写入；定位失败时不写数据，
+  * @note   失败的窗口标记 failed，由下一次 OLED_Flush() 重新标记为脏
+  * @param  None
   * @retval None
   */
-void OLED_WriteData(uint8_t Data) {
-    IIC_Start(OLED_IIC_BUS);
-    IIC_SendByte(OLED_IIC_BUS, OLED_IIC_ADDR);
-    IIC_RcvACK(OLED_IIC_BUS);
-    IIC_SendByte(OLED_IIC_BUS, 0x40);
-    IIC_RcvACK(OLED_IIC_BUS);
-    IIC_SendByte(OLED_IIC_BUS, Data);
-    IIC_RcvACK(OLED_IIC_BUS);
-    IIC_Stop(OLED_IIC_BUS);
+static void OLED_SendFrame() {
+    uint8_t i;
+    OLED_Window* win;
+
+    for (i = 0; i < OLED_TxWinCount; i++) {
+        win = &OLED_TxWin[i];
+        if (!OLED_SetWindow(win->x1, win->x2, win->p1, win->p2)) {
+            win->failed = true;
+            continue;
+        }
+        if (!OLED_WriteDataBurst(&OLED_TxBuf[win->offset], (win->x2 - win->x1 + 1) * (win->p2 - win->p1 + 1))) {
+            // 写入中断，控制器指针不再位于窗口起点
+            OLED_State.colStart = OLED_STATE_UNKNOWN;
+            win->failed = true;
+        }
+    }
 }
 
+/**
+  * @brief  把上一帧发送失败的窗口重新标记为脏 (主循环调用，上一帧已发送完毕)
+  * @note   显存去重使未变化的内容不会再被写入，不重新标记则屏幕一直停留在错误的内容
+  * @retval None
+  */
+static void OLED_RedirtyFailed() {
+    uint8_t i, p;
+    const OLED_Window* win;
+
+    for (i = 0; i < OLED_TxWinCount; i++) {
+        win = &OLED_TxWin[i];
+        if (!win->failed) {
+            continue;
+        }
+        for (p = win->p1; p <= win->p2; p++) {
+            if (OLED_DirtyX1[p] > OLED_DirtyX2[p]) {
+                OLED_DirtyX1[p] = win->x1;
+                OLED_DirtyX2[p] = win->x2;
+            } else {
+                if (win->x1 < OLED_DirtyX1[p]) {
+                    OLED_DirtyX1[p] = win->x1;
+                }
+                if (win->x2 > OLED_DirtyX2[p]) {
+                    OLED_DirtyX2[p] = win->x2;
+                }
+            }
+        }
+    }
+    OLED_TxWinCount = 0;
+}
 
 /**
-  * @brief  OLED 设置光标位置
-  * @param  x: X坐标 (0-127)
-  * @param  y: 行坐标 (0-7)
-  * @note   (0,0)------------->(127,0)
-  * @note   (0,7)------------->(127,7)
+  * @brief  把显存脏区按窗口快照到发送缓冲区并清除脏标记
+  * @note   相邻的脏页在合并后总线字节数不增加时合并为一个矩形窗口，
+  * @note   合并窗口中未改动的列会一并重发，以省去额外的定位与传输开销
+  * @retval 是否存在需要发送的内容
+  */
+static bool OLED_CollectDirty() {
+    uint8_t i, p;
+    uint8_t pages = OLED_PageCount();
+    uint16_t offset = 0;
+    uint16_t width, splitCost, mergedCost;
+    OLED_Window* win = NULL;
+
+    OLED_TxWinCount = 0;
+
+    // 第一步：规划窗口
+    for (i = 0; i < pages; i++) {
+        if (OLED_DirtyX1[i] > OLED_DirtyX2[i]) {
+            win = NULL; // 干净页打断合并
+            continue;
+        }
+
+        if (win != NULL) {
+            // 比较：当前窗口向下扩展一页 vs 新开一个窗口
+            uint8_t x1 = (OLED_DirtyX1[i] < win->x1) ? OLED_DirtyX1[i] : win->x1;
+            uint8_t x2 = (OLED_DirtyX2[i] > win->x2) ? OLED_DirtyX2[i] : win->x2;
+            width = win->x2 - win->x1 + 1;
+            splitCost = width * (win->p2 - win->p1 + 1) + (OLED_DirtyX2[i] - OLED_DirtyX1[i] + 1) + OLED_WINDOW_COST;
+            mergedCost = (x2 - x1 + 1) * (win->p2 - win->p1 + 2);
+            if (mergedCost <= splitCost) {
+                win->x1 = x1;
+                win->x2 = x2;
+                win->p2 = i;
+                continue;
+            }
+        }
+
+        win = &OLED_TxWin[OLED_TxWinCount++];
+        win->x1 = OLED_DirtyX1[i];
+        win->x2 = OLED_DirtyX2[i];
+        win->p1 = i;
+        win->p2 = i;
+        win->failed = false;
+    }
+
+    // 第二步：按水平寻址顺序 (逐页、页内逐列) 拷贝窗口数据
+    for (i = 0; i < OLED_TxWinCount; i++) {
+        win = &OLED_TxWin[i];
+        width = win->x2 - win->x1 + 1;
+        win->offset = offset;
+        for (p = win->p1; p <= win->p2; p++) {
+            memcpy(&OLED_TxBuf[offset], &OLED_GRAM[p][win->x1], width);
+            offset += width;
+            OLED_DirtyX1[p] = 0xFF;
+            OLED_DirtyX2[p] = 0x00;
+        }
+    }
+
+    return OLED_TxWinCount > 0;
+}
+
+/**
+  * @brief  OLED 后台刷新任务
+  * @note   先发送排队的控制命令，再发送 OLED_Flush() 提交的帧，完成后回调通知
+  * @param  pvParameter: 未使用
   * @retval None
   */
-void OLED_SetCursor(uint8_t x, uint8_t y) {
-    uint8_t lines = 7;
-    if (OLED_HEIGHT == 32) {
-        lines = 3;
+static void OLED_FlushTask(void* pvParameter) {
+    OLED_CmdPacket packet;
+
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        while (xQueueReceive(OLED_CmdQueue, &packet, 0) == pdTRUE) {
+            OLED_WriteCommands(packet.cmds, packet.len);
+        }
+
+        if (OLED_TxBusy) {
+            OLED_SendFrame();
+            __sync_synchronize(); // 失败标记先于忙标志对主循环可见
+            OLED_TxBusy = false;
+            if (OLED_FlushDoneCb != NULL) {
+                OLED_FlushDoneCb();
+            }
+        }
+    }
+}
+
+/**
+  * @brief  提交显存中的脏区刷新到屏幕 (非阻塞)
+  * @note   只发送每页内容发生变化的列范围，画面未变化时不产生任何 I2C 流量
+  * @note   上一帧仍在发送时直接返回，脏区保留到下一次提交
+  * @param  None
+  * @retval 是否提交了新的一帧
+  */
+bool OLED_Flush() {
+    if (OLED_TxBusy) {
+        return false;
     }
-    if (y > lines) {
-        y = lines;
+    OLED_RedirtyFailed();
+    if (!OLED_CollectDirty()) {
+        return false;
     }
-    if (x > 127) {
-        x = 127;
+
+    if (OLED_FlushTaskHandle == NULL) {
+        OLED_SendFrame(); // 刷新任务启动前 (初始化阶段) 同步发送
+        return true;
     }
-    OLED_WriteCommand(0xB0 + y); //设置页地址
-    OLED_WriteCommand(0x00 | (x & 0x0F)); //设置列低地址
-    OLED_WriteCommand(0x10 | ((x & 0xF0) >> 4)); //设置列高地址
+
+    __sync_synchronize(); // 确保发送缓冲区写入先于忙标志对刷新任务可见
+    OLED_TxBusy = true;
+    xTaskNotifyGive(OLED_FlushTaskHandle);
+    return true;
+}
+
+/**
+  * @brief  查询是否有帧正在后台发送
+  * @retval true 正在发送
+  */
+bool OLED_IsBusy() {
+    return OLED_TxBusy;
 }
 
 /**
-  * @brief  OLED 清屏
+  * @brief  设置帧发送完成回调
+  * @note   回调在刷新任务上下文中执行，应尽量简短
+  * @param  cb: 回调函数，NULL 表示取消
+  * @retval None
+  */
+void OLED_SetFlushCallback(void (*cb)(void)) {
+    OLED_FlushDoneCb = cb;
+}
+
+/**
+  * @brief  OLED 清屏 (清空显存)
   * @param  None
   * @retval None
   */
 void OLED_Clear() {
     uint8_t i, j;
-    uint8_t lines = 8;
-
-    if (OLED_HEIGHT == 32) {
-        lines = 4;
-    }
+    uint8_t lines = OLED_PageCount();
 
     for (i = 0; i < lines; i++) {
-        OLED_SetCursor(0, i);
-        for (j = 0; j < 128; j++) {
-            OLED_WriteData(0x00);
+        for (j = 0; j < OLED_WIDTH; j++) {
+            OLED_GRAM_Write(j, i, 0x00);
         }
     }
-    OLED_SetCursor(0, 0);
 }
 
 /**
@@ -93,26 +438,53 @@ void OLED_Clear() {
 void OLED_ClearPart(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2) {
     uint8_t i, j;
     for (i = y1; i < y2; i++) {
-        OLED_SetCursor(x1, i);
         for (j = x1; j < x2; j++) {
-            OLED_WriteData(0x00);
+            OLED_GRAM_Write(j, i, 0x00);
         }
     }
-    OLED_SetCursor(x1, y1);
+}
+
+/**
+  * @brief  OLED 设置寻址模式
+  * @note   与控制器当前模式相同时不发送
+  * @param  mode: 0x00 水平, 0x01 垂直, 0x02 页寻址
+  * @retval None
+  */
+static void OLED_SetAddrMode(uint8_t mode) {
+    uint8_t cmds[2] = {0x20, mode};
+
+    if (OLED_State.addrMode == mode) {
+        OLED_STAT_ADD(OLED_CmdSuppressed, 2);
+        return;
+    }
+    if (OLED_QueueCommands(cmds, 2)) {
+        OLED_State.addrMode = mode;
+    }
 }
 
 /**
   * @brief  OLED 初始化
-  * @param  None
+  * @param  scl: SCL引脚号
+  * @param  sda: SDA引脚号
+  * @param  height: 屏幕高度 (32)，显存只按 OLED_MAX_HEIGHT 分配，更高的屏幕按 OLED_MAX_HEIGHT 配置
+  * @param  bus: IIC总线号 (0-7)
+  * @param  backend: 总线后端 (IIC_BACKEND_SOFT/IIC_BACKEND_HW)，硬件初始化失败时退回软件IIC
   * @retval None
   */
-void OLED_Init(uint8_t scl, uint8_t sda, uint8_t height, uint8_t bus) {
+void OLED_Init(uint8_t scl, uint8_t sda, uint8_t height, uint8_t bus, uint8_t backend) {
 
+    if (height > OLED_MAX_HEIGHT) {
+        height = OLED_MAX_HEIGHT;
+    }
     OLED_HEIGHT = height;
     OLED_IIC_BUS = bus;
 
     delay(50);
-    IIC_Init(scl, sda, 0, bus);
+    if (backend == IIC_BACKEND_HW) {
+        IIC_InitHW(scl, sda, OLED_IIC_FREQ, bus);
+    } else {
+        IIC_Init(scl, sda, 0, bus);
+    }
     delay(20);
 
     OLED_WriteCommand(0xAE); //关闭显示
@@ -159,11 +531,30 @@ void OLED_Init(uint8_t scl, uint8_t sda, uint8_t height, uint8_t bus) {
     OLED_WriteCommand(0x8D);
     OLED_WriteCommand(0x14); //设置充电泵开启
 
+    OLED_State.addrMode = OLED_STATE_UNKNOWN;
+    OLED_SetAddrMode(0x00); //设置水平寻址模式 (按窗口连续写入)
+
     OLED_WriteCommand(0xAF); //开启显示
 
+    OLED_State.contrast = 0xCF;
+    OLED_State.displayOn = true;
+    OLED_State.colStart = OLED_STATE_UNKNOWN;
+    OLED_State.colEnd = OLED_STATE_UNKNOWN;
+    OLED_State.pageStart = OLED_STATE_UNKNOWN;
+    OLED_State.pageEnd = OLED_STATE_UNKNOWN;
+
     delay(30);
 
-    OLED_Clear();
+    // 上电后 GDDRAM 内容未知，清空显存并整屏刷新一次
+    memset(OLED_GRAM, 0x00, sizeof(OLED_GRAM));
+    OLED_InvalidateAll();
+    OLED_Flush();
+
+    // 之后的所有总线操作都交给后台刷新任务
+    if (OLED_FlushTaskHandle == NULL) {
+        OLED_CmdQueue = xQueueCreate(OLED_CMD_QUEUE_LEN, sizeof(OLED_CmdPacket));
+        xTaskCreate(OLED_FlushTask, "oled", OLED_TASK_STACK, NULL, OLED_TASK_PRIORITY, &OLED_FlushTaskHandle);
+    }
 }
 
 /**
@@ -181,39 +572,35 @@ void OLED_PrintText(uint8_t x, uint8_t y, const char* str, uint8_t size) {
     if (str[1] == '\0') {
 
         character = str[0];
-        OLED_SetCursor(x, y);
         if (size == 8) {
             for (i = 0; i < 6; i++) {
-                OLED_WriteData(OLED_ASCII6x8[character - ' '][i]);
+                OLED_GRAM_Write(x + i, y, OLED_ASCII6x8[character - ' '][i]);
             }
         } else if (size == 16) {
             for (i = 0; i < 8; i++) {
-                OLED_WriteData(OLED_ASCII8x16[character - ' '][i]);
+                OLED_GRAM_Write(x + i, y, OLED_ASCII8x16[character - ' '][i]);
             }
-            OLED_SetCursor(x, y + 1);
             for (i = 0; i < 8; i++) {
-                OLED_WriteData(OLED_ASCII8x16[character - ' '][i + 8]);
+                OLED_GRAM_Write(x + i, y + 1, OLED_ASCII8x16[character - ' '][i + 8]);
             }
         }
     
     } else {
 
         while (str[j] != '\0') {
-            OLED_SetCursor(x, y);
             character = str[j]; //获取当前字符
 
             if (size == 8 && (character - ' ') < 95) {
                 for (i = 0; i < 6; i++) {
-                    OLED_WriteData(OLED_ASCII6x8[character - ' '][i]);
+                    OLED_GRAM_Write(x + i, y, OLED_ASCII6x8[character - ' '][i]);
                 }
                 x += 6;
             } else if (size == 16 && (character - ' ') < 95) {
                 for (i = 0; i < 8; i++) {
-                    OLED_WriteData(OLED_ASCII8x16[character - ' '][i]);
+                    OLED_GRAM_Write(x + i, y, OLED_ASCII8x16[character - ' '][i]);
                 }
-                OLED_SetCursor(x, y + 1);
                 for (i = 0; i < 8; i++) {
-                    OLED_WriteData(OLED_ASCII8x16[character - ' '][i + 8]);
+                    OLED_GRAM_Write(x + i, y + 1, OLED_ASCII8x16[character - ' '][i + 8]);
                 }
                 x += 8;
             }
@@ -244,9 +631,8 @@ void OLED_PrintText(uint8_t x, uint8_t y, const char* str, uint8_t size) {
 void OLED_PrintImage(uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t* image) {
     uint8_t i, j;
     for (i = 0; i < height; i++) {
-        OLED_SetCursor(x, y + i);
         for (j = 0; j < width; j++) {
-            OLED_WriteData(image[i * width + j]);
+            OLED_GRAM_Write(x + j, y + i, image[i * width + j]);
         }
     }
 }
@@ -286,9 +672,8 @@ void OLED_PrintVar(uint8_t x, uint8_t y, float num, const char* type, uint8_t le
     }
 
     for (j = 0; str[j] != '\0'; j++) {
-        OLED_SetCursor(x, y);
         for (i = 0; i < 6; i++) {
-            OLED_WriteData(OLED_ASCII6x8[str[j] - ' '][i]);
+            OLED_GRAM_Write(x + i, y, OLED_ASCII6x8[str[j] - ' '][i]);
         }
         x += 6;
     }
@@ -304,8 +689,7 @@ void OLED_PrintVar(uint8_t x, uint8_t y, float num, const char* type, uint8_t le
 void OLED_PrintHLine(uint8_t x, uint8_t y, uint8_t width) {
     uint8_t i;
     for (i = 0; i < width; i++) {
-        OLED_SetCursor(x + i, y);
-        OLED_WriteData(0x01);
+        OLED_GRAM_Write(x + i, y, 0x01);
     }
 }
 
@@ -319,25 +703,59 @@ void OLED_PrintHLine(uint8_t x, uint8_t y, uint8_t width) {
 void OLED_PrintVLine(uint8_t x, uint8_t y, uint8_t height) {
     uint8_t i;
     for (i = 0; i < height; i++) {
-        OLED_SetCursor(x, y + i);
-        OLED_WriteData(0xFF);
+        OLED_GRAM_Write(x, y + i, 0xFF);
+    }
+}
+
+/**
+  * @brief  OLED 设置对比度 (亮度)
+  * @note   与控制器当前值相同时不发送
+  * @param  contrast: 对比度 (0x00-0xFF)
+  * @retval None
+  */
+void OLED_SetContrast(uint8_t contrast) {
+    uint8_t cmds[2] = {0x81, contrast};
+
+    if (OLED_State.contrast == contrast) {
+        OLED_STAT_ADD(OLED_CmdSuppressed, 2);
+        return;
+    }
+    if (OLED_QueueCommands(cmds, 2)) {
+        OLED_State.contrast = contrast;
     }
 }
 
 void OLED_LowBrightness(bool lowBrightness) {
-    OLED_WriteCommand(0x00);
-    OLED_WriteCommand(0x81);
     if(lowBrightness) {
-        OLED_WriteCommand(0x01);
+        OLED_SetContrast(0x01);
     } else {
-        OLED_WriteCommand(0xCF);
+        OLED_SetContrast(0xCF);
     }
 }
 
 void OLED_Power(bool state) {
-    if(state) {
-        OLED_WriteCommand(0xAF);
-    } else {
-        OLED_WriteCommand(0xAE);
+    uint8_t command = state ? 0xAF : 0xAE;
+
+    if (OLED_State.displayOn == state) {
+        OLED_STAT_ADD(OLED_CmdSuppressed, 1);
+        return;
+    }
+    if (OLED_QueueCommands(&command, 1)) {
+        OLED_State.displayOn = state;
+    }
+}
+
+/**
+  * @brief  获取命令统计
+  * @param  sent: 输出，实际发送的命令字节数 (可为 NULL)
+  * @param  suppressed: 输出，因与控制器状态相同而省略的命令字节数 (可为 NULL)
+  * @retval None
+  */
+void OLED_GetCmdStats(uint32_t* sent, uint32_t* suppressed) {
+    if (sent != NULL) {
+        *sent = OLED_CmdSent;
+    }
+    if (suppressed != NULL) {
+        *suppressed = OLED_CmdSuppressed;
     }
 }
\ No newline at end of file
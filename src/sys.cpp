@@ -12,6 +12,11 @@
 
 #include "sys.h"
 #include "ui_manager.h"
+#include "hidReport.h"
+#include "tapHold.h"
+#include "combo.h"
+#include "macro.h"
+#include "esp_timer.h"
 #include <Preferences.h> // ESP32 NVS (非易失性存储) 库
 
 // 系统当前运行模式，默认为普通模式
@@ -29,8 +34,9 @@ struct SystemStatus sysStatus = {
  * 0x10: Right Ctrl  0x20: Right Shift  0x40: Right Alt   0x80: Right GUI
  * * HID 报文结构 (8 Bytes):
  * Byte 0: 修饰键
- * Byte 1: 保留位 (Reserved)
+ * Byte 1: 保留位 (Reserved)，在键位中用作层操作标记 (KM_TRNS / KM_MO / KM_TG / KM_OSL，见 keymap.h)
  * Byte 2-7: 6个普通按键键值 (Keycodes)
+ * 预设的 keymap 为基础层，可通过 layers/layerCount 追加最多 15 个上层
  */
 
 KeyPreset presets[PRESET_COUNT] = {
@@ -60,6 +66,19 @@ KeyPreset presets[PRESET_COUNT] = {
         "Video",                                  // 预设名称
         {"Cut", "Paste", "Space", "~", "}"} // OLED 显示描述：~和}会显示为你改好的左右长箭头
     },
+
+    // --- 预设 3 :  宏 (宏序号见 SYS_KeyActionInit 中的宏表) ---
+    {
+        {
+            KM_MACRO(0),                                      // Key 1: 全选并复制
+            KM_MACRO(1),                                      // Key 2: 粘贴并回车
+            {0x01, 0x00, 0x1D, 0x00, 0x00, 0x00, 0x00, 0x00}, // Key 3: Ctrl+Z (撤销)
+            {0x00, 0x00, 0x50, 0x00, 0x00, 0x00, 0x00, 0x00}, // Key 4: Left Arrow  (左箭头)
+            {0x00, 0x00, 0x4F, 0x00, 0x00, 0x00, 0x00, 0x00}  // Key 5: Right Arrow (右箭头)
+        },
+        "Macro",
+        {"Copy all", "Paste+Enter", "Undo", "~", "}"}
+    },
 };
 
 // 备用媒体键码表 (目前未使用)
@@ -73,121 +92,146 @@ char media[5][2]{
 // 全局控制变量
 uint8_t currentPreset = 0; // 当前选中的预设索引
 bool changeName = false;   // 预设切换标志 (用于触发 UI 刷新)
+uint8_t hostSlotSel = 0;   // 主机选择界面中光标所在的槽位
 
 bool active = false;           // 系统活跃标志
+static bool textActive = false; // 文本输入进行中，结束后需重发合成器状态
 
 /**
  * @brief  系统模式切换状态机 (FSM)
- * @note   根据按键的长按操作切换系统工作模式
- * @logic  逻辑优化：单键触发进入/退出
- * 长按 Key1 <-> 系统配置模式
- * 长按 Key2 <-> 定时器模式
- * 长按 Key3 <-> 节拍器模式
+ * @note   由按住动作或组合键 (ACT_MODE) 触发，单键进入/退出：
+ * 按住 Key1 <-> 系统配置模式
+ * 按住 Key2 <-> 定时器模式
+ * 按住 Key3 <-> 节拍器模式
+ * Key1 + Key2 同时按下 <-> 主机选择模式
+ * 非正常模式下只响应退出当前模式的那个动作，其他模式的按住/组合被忽略
+ * @param  mode 目标模式，当前已在该模式时返回正常模式
  */
-void SYS_ModeSwitch()
+void SYS_ModeSwitch(SystemMode mode)
 {
-    // --- 1. 检测 Key 1 长按 (系统配置模式) ---
-    if (keyLongPressed[0])
-    {
-        // 如果当前已经在配置模式，则退出回正常模式
-        if (currentMode == MODE_KEY_CONFIG)
-        {
-            currentMode = MODE_NORMAL;
-        }
-        // 否则进入配置模式
-        else
-        {
-            currentMode = MODE_KEY_CONFIG;
-        }
+    // 切换前的按键边沿属于旧模式，不交给新模式的界面逻辑 (例如触发组合键的第二个按下沿)
+    KEY_ClearEdges();
 
-        // [BUG 修复] 等待 Key 1 物理释放
-        // 必须等待手指抬起，否则因为 Key 1 同时也是 SYS_KeyConfig 的确认键，
-        // 会导致刚进配置模式就立刻触发“确认退出”，造成闪退。
-        while (keyState[0].isPressed) {
-            KEY_Update(); // 现在这里可以正确链接到 C 函数了
-            delay(10);
-        }
-
-        // 复位长按标志和计时器
-        keyLongPressed[0] = false;
-        keyPressStartTime[0] = 0;
+    // 如果当前已经在目标模式，则退出回正常模式
+    if (currentMode == mode)
+    {
+        currentMode = MODE_NORMAL;
+        return;
     }
 
-    // --- 2. 检测 Key 2 长按 (定时器模式) ---
-    else if (keyLongPressed[1])
+    // 其他模式中不能直接跳转 (按键在这些模式下另有用途，例如配置模式下 Key4 的连续切换)
+    if (currentMode != MODE_NORMAL)
     {
-        // 如果当前已经在定时器模式，则退出回正常模式
-        if (currentMode == MODE_TIMER_SET)
-        {
-            currentMode = MODE_NORMAL;
-        }
-        // 否则进入定时器模式
-        else
-        {
-            currentMode = MODE_TIMER_SET;
-        }
-
-        keyLongPressed[1] = false;
-        keyPressStartTime[1] = 0;
+        return;
     }
 
-    // --- 3. 检测 Key 3 长按 (节拍器模式) ---
-    else if (keyLongPressed[2])
+    // 注意：Key 1 同时也是 SYS_KeyConfig 的确认键。确认只响应按下沿 (pressEdge)，
+    // 按住进入配置模式时手指尚未抬起，不会产生新的按下沿，因此无需在此阻塞等待释放。
+    if (mode == MODE_HOST_SELECT)
     {
-        // 如果当前已经在节拍器模式，则退出回正常模式
-        if (currentMode == MODE_METRONOME)
-        {
-            currentMode = MODE_NORMAL;
-        }
-        // 否则进入节拍器模式
-        else
-        {
-            currentMode = MODE_METRONOME;
-        }
+        hostSlotSel = keybrick.getActiveHostSlot(); // 光标从当前槽位开始
+    }
+    currentMode = mode;
+}
 
-        keyLongPressed[2] = false;
-        keyPressStartTime[2] = 0;
+// 界面按键自动重复：按住超过 SYS_REPEAT_DELAY_MS 后每 SYS_REPEAT_RATE_MS 重复一次
+#define SYS_REPEAT_DELAY_MS 400
+#define SYS_REPEAT_RATE_MS  100
+
+/**
+ * @brief  界面按键步进 (不阻塞)
+ * @note   按下沿触发一次，之后按住则自动重复
+ * @param  i 按键索引 (0-4)
+ * @retval 本次是否步进
+ */
+static bool SYS_KeyRepeat(uint8_t i)
+{
+    static uint32_t repeatAt[5];
+    uint32_t now = millis();
+
+    if (keyState[i].pressEdge)
+    {
+        repeatAt[i] = now + SYS_REPEAT_DELAY_MS;
+        return true;
     }
+    if (keyState[i].isPressed && (int32_t)(now - repeatAt[i]) >= 0)
+    {
+        repeatAt[i] = now + SYS_REPEAT_RATE_MS;
+        return true;
+    }
+    return false;
 }
 
 /**
  * @brief  处理按键配置模式下的交互逻辑
- * @note   用于切换和选择不同的按键预设 (Preset)
- * @ui     Key 4: 上一个预设, Key 5: 下一个预设, Key 1: 确认并应用
+ * @note   用于切换和选择不同的按键预设 (Preset)，只响应按下沿与自动重复，不阻塞主循环
+ * @ui     Key 4: 上一个预设, Key 5: 下一个预设 (按住连续切换), Key 1: 确认并应用
  */
 void SYS_KeyConfig()
 {
     // Key 4: 切换到上一个预设
     // 对应 keyState[3]
-    if (keyState[3].isPressed)
+    if (SYS_KeyRepeat(3))
     {
         currentPreset = (currentPreset + PRESET_COUNT - 1) % PRESET_COUNT;
         UIManager::resetScroll();
         changeName = true; // 触发 UI 刷新名称
-        delay(100);        // 简单防抖
     }
 
     // Key 5: 切换到下一个预设
     // 对应 keyState[4]
-    if (keyState[4].isPressed)
+    if (SYS_KeyRepeat(4))
     {
         currentPreset = (currentPreset + 1) % PRESET_COUNT;
         changeName = true;
         UIManager::resetScroll();
-        delay(100);
     }
 
     // Key 1: 确认选择
-    // 对应 keyState[0]
-    if (keyState[0].isPressed)
+    // 对应 keyState[0]，只响应新的按下沿 (进入配置模式的那次长按不算)
+    // 非键盘模式下按键不发送报文，返回正常模式后无需等待 Key 1 抬起
+    if (keyState[0].pressEdge)
     {
         SYS_ConfirmPreset(currentPreset); // 保存到 NVS
         SYS_ApplyPreset(currentPreset);   // 应用配置
-        delay(500);
         currentMode = MODE_NORMAL; // 返回正常模式
     }
 }
 
+/**
+ * @brief  处理主机选择模式下的交互逻辑
+ * @note   在多个已绑定主机之间切换，切换后立即对新主机定向广播重连
+ * @ui     Key 2: 上一个槽位, Key 5: 下一个槽位, Key 1: 切换到该槽位, Key 3: 清除该槽位的绑定
+ */
+void SYS_HostSelect()
+{
+    if (keyState[1].pressEdge)
+    {
+        hostSlotSel = (hostSlotSel + HID2BLE_HOST_SLOTS - 1) % HID2BLE_HOST_SLOTS;
+    }
+
+    if (keyState[4].pressEdge)
+    {
+        hostSlotSel = (hostSlotSel + 1) % HID2BLE_HOST_SLOTS;
+    }
+
+    // Key 3: 清除光标所在槽位 (先切换过去再清除)，之后配对的新主机绑定到该槽位
+    if (keyState[2].pressEdge)
+    {
+        keybrick.selectHostSlot(hostSlotSel);
+        keybrick.forgetHost();
+        tone(BUZZER_PIN, 500, 100);
+    }
+
+    // Key 1: 切换主机并返回正常模式
+    if (keyState[0].pressEdge)
+    {
+        keybrick.selectHostSlot(hostSlotSel);
+        tone(BUZZER_PIN, 1000, 100);
+        currentMode = MODE_NORMAL;
+    }
+}
+
 // 预留接口：保存自定义预设
 void SYS_SavePreset()
 {
@@ -219,7 +263,7 @@ void SYS_ConfirmPreset(uint8_t preset)
 
 /**
  * @brief  应用指定的预设方案
- * @note   将 Flash 中的预设数据拷贝到活动的发送缓冲区 (kBuf)，并给予蜂鸣器反馈
+ * @note   只把键位层栈指向该预设 (不复制键位)，下一个按键事件即生效；蜂鸣器反馈不阻塞
  * @param  presetIndex 预设在数组中的索引
  */
 void SYS_ApplyPreset(uint8_t presetIndex)
@@ -229,16 +273,10 @@ void SYS_ApplyPreset(uint8_t presetIndex)
         return;
     } // 边界检查
 
-    // 将预设数据 (ROM) 复制到 运行时缓冲区 (RAM)
-    memcpy(k1Buf, presets[presetIndex].keymap[0], 8);
-    memcpy(k2Buf, presets[presetIndex].keymap[1], 8);
-    memcpy(k3Buf, presets[presetIndex].keymap[2], 8);
-    memcpy(k4Buf, presets[presetIndex].keymap[3], 8);
-    memcpy(k5Buf, presets[presetIndex].keymap[4], 8);
+    KM_SetKeymap(presets[presetIndex].keymap, presets[presetIndex].layers, presets[presetIndex].layerCount);
 
     // 成功提示音
     tone(BUZZER_PIN, 1000, 100);
-    delay(100);
 }
 
 /**
@@ -292,7 +330,7 @@ Hid2Ble keybrick("ESP32C3 BLE Keybrick", "dxj", 100);
 
 /**
  * @brief  按键检测与系统定时器中断服务函数
- * @note   触发频率: 10ms (100Hz)
+ * @note   触发频率: KEY_SCAN_PERIOD_US (默认 1ms, 1kHz)
  * @note   IRAM_ATTR 属性强制将此函数加载到 IRAM 中运行，
  * 避免 Flash 缓存未命中（Cache Miss）导致的中断延迟，保证实时性。
  */
@@ -300,48 +338,41 @@ void IRAM_ATTR KEY_Detect()
 {
 
     // --- 1. 按键状态扫描与去抖逻辑 ---
-    // 遍历 5 个物理按键
-    for (int i = 0; i < 5; i++)
-    {
-        if (keyState[i].isReleased)
-        {
-            // 逻辑：当按键被物理释放，且之前处于按下状态时，标记发送“释放”信号
-            if (!keyState[i].isPressed)
-            {
-                sendRelease = true;             // 全局标志位：请求发送 Key Release
-                keyState[i].isReleased = false; // 复位状态
-            }
-        }
-        else
-        {
-            // 逻辑：当按键处于按下状态，标记 shouldSend 请求主循环发送键值
-            if (keyState[i].isPressed)
-            {
-                keyState[i].shouldSend = true;
-            }
-        }
-    }
+    KEY_Scan(); // 读取 GPIO 寄存器快照并去抖，按下/释放/长按写入事件队列
 
     // --- 2. 倒计时定时器逻辑 (Timer Mode) ---
-    // 通过累加 10ms 中断次数来实现秒级计时
-    static uint8_t timerCnt = 0;
+    // 通过累加扫描中断次数来实现秒级计时，每秒投递一个 TICK 事件，由主循环判定是否到期
+    static uint16_t timerCnt = 0;
     if (timer.enabled)
     {
         timerCnt++;
-        if (timerCnt >= 100)
-        { // 10ms * 100 = 1000ms = 1s
-            uint32_t now = millis();
-            // 检查是否到达目标时间
-            if (now >= (timer.targetSec - 1))
-            {
-                timerTriggered = true; // 触发定时器结束事件
-                timer.enabled = false; // 停止计时
-            }
+        if (timerCnt >= 1000000 / KEY_SCAN_PERIOD_US)
+        { // 1ms * 1000 = 1000ms = 1s
+            KEY_PostTick();
             timerCnt = 0; // 重置秒计数器
         }
     }
 }
 
+/**
+ * @brief  秒计时 (TICK) 事件处理
+ * @note   由 KEY_Update 在主循环上下文中调用，timerTriggered 只在主循环中读写
+ */
+void SYS_TimerTick()
+{
+    if (!timer.enabled)
+    {
+        return;
+    }
+
+    // 检查是否到达目标时间
+    if (millis() >= (timer.targetSec - 1))
+    {
+        timerTriggered = true; // 触发定时器结束事件
+        timer.enabled = false; // 停止计时
+    }
+}
+
 /**
  * @brief  电池电量更新中断
  * @note   触发频率: 1分钟
@@ -356,47 +387,264 @@ void IRAM_ATTR BLE_UpdateBAT()
 }
 
 /**
- * @brief  处理 HID 报文发送逻辑
- * @note   根据 keyState 状态构建并发送 BLE 报文
+ * @brief  合成并发送有变化的报文
+ * @note   先发当前模式的报文，再发另一个被清空的报文，6KRO/NKRO 切换时主机不会看到短暂的释放
+ *         报文未能入队时作废合成器缓存，下次合成重发完整状态，避免按键卡住
  */
-void KEY_Send()
+static void KEY_SendComposed()
 {
-    // 遍历所有按键，检查是否有待发送的按下事件
-    for (int i = 0; i < 5; i++)
+    HID_Output out;
+    uint8_t send = HID_Compose(&out);
+    bool ok = true;
+
+    if (out.mode == HID_MODE_NKRO)
+    {
+        if (send & HID_SEND_NKRO)
+        {
+            ok &= keybrick.sendNkro2Ble(out.nkro);
+        }
+        if (send & HID_SEND_BOOT)
+        {
+            ok &= keybrick.send2Ble((char *)out.boot);
+        }
+    }
+    else
+    {
+        if (send & HID_SEND_BOOT)
+        {
+            ok &= keybrick.send2Ble((char *)out.boot);
+        }
+        if (send & HID_SEND_NKRO)
+        {
+            ok &= keybrick.sendNkro2Ble(out.nkro);
+        }
+    }
+    if (!ok)
+    {
+        HID_Invalidate();
+    }
+}
+
+/**
+ * @brief  tap-hold 引擎的动作输出
+ * @note   报文动作提交给报文合成器 (hidReport)，已连接时立即发送，一次轻按的按下/释放会各自完整上报；
+ *         非键盘模式下只响应模式切换，报文动作的按下被忽略
+ */
+static void SYS_KeyAction(uint8_t key, const KeyAction *act, bool down)
+{
+    switch (act->type)
     {
-        if (keyState[i].shouldSend && !keyState[i].isReleased)
+    case ACT_REPORT:
+    case ACT_MODS:
+        if (down)
         {
+            if (!enableKey)
+            {
+                return;
+            }
+            if (act->type == ACT_MODS)
+            {
+                uint8_t report[HID_REPORT_LEN] = {act->arg};
+                HID_KeyDown(key, report);
+            }
+            else
+            {
+                HID_KeyDown(key, act->report);
+            }
+        }
+        else
+        {
+            HID_KeyUp(key);
+        }
+        if (keybrick.isConnected())
+        {
+            KEY_SendComposed();
+        }
+        break;
 
-            // 根据按键索引发送对应的键值缓冲区 (Key Buffer)
-            switch (i)
+    case ACT_KEYMAP:
+        if (down)
+        {
+            const uint8_t *report = KM_KeyDown(key); // 层操作在此生效，返回 NULL
+            if (!report || !enableKey)
             {
-            case 0:
-                keybrick.send2Ble(k1Buf);
-                break;
-            case 1:
-                keybrick.send2Ble(k2Buf);
-                break;
-            case 2:
-                keybrick.send2Ble(k3Buf);
-                break;
-            case 3:
-                keybrick.send2Ble(k4Buf);
-                break;
-            case 4:
-                keybrick.send2Ble(k5Buf);
-                break;
+                return;
             }
+            if (report[1] == KM_TAG_MACRO)
+            {
+                MAC_Start(report[2]);
+                return;
+            }
+            HID_KeyDown(key, report);
+        }
+        else
+        {
+            if (!KM_KeyUp(key))
+            {
+                return;
+            }
+            HID_KeyUp(key);
+        }
+        if (keybrick.isConnected())
+        {
+            KEY_SendComposed();
+        }
+        break;
+
+    case ACT_LAYER:
+        if (down)
+        {
+            KM_LayerOn(act->arg);
+        }
+        else
+        {
+            KM_LayerOff(act->arg);
+        }
+        break;
+
+    case ACT_MACRO:
+        if (down && enableKey)
+        {
+            MAC_Start(act->arg);
+        }
+        break;
+
+    case ACT_TEXT:
+        if (down && enableKey)
+        {
+            textActive |= keybrick.typeString((const char *)act->report);
+        }
+        break;
 
-            // 发送后状态流转：等待释放，且清除“待发送”标志
-            keyState[i].isReleased = true;
-            keyState[i].shouldSend = false;
+    case ACT_MODE:
+        if (down)
+        {
+            SYS_ModeSwitch((SystemMode)act->arg);
         }
+        break;
     }
+}
 
-    // 处理全局释放事件 (All Keys Released)
-    if (sendRelease)
+/**
+ * @brief  宏引擎的报文输出
+ * @note   宏作为一个独立的报文来源 (MAC_SOURCE) 与按住的按键合并
+ */
+static void SYS_MacroOutput(const uint8_t *report)
+{
+    if (report)
+    {
+        HID_KeyDown(MAC_SOURCE, report);
+    }
+    else
     {
-        keybrick.send2Ble(release); // 发送空报文，告诉主机按键已抬起
-        sendRelease = false;
+        HID_KeyUp(MAC_SOURCE);
     }
-}
\ No newline at end of file
+    KEY_SendComposed();
+}
+
+/**
+ * @brief  推进宏执行 (主循环调用)
+ * @note   每次最多填满发送队列中除 MAC_TX_RESERVE 以外的空位，发送任务按协商的连接间隔发出，
+ *         宏以链路允许的最快速度输出而不阻塞 loop()；执行期间保持低延迟连接参数
+ */
+void SYS_MacroUpdate()
+{
+    uint8_t budget = 0;
+
+    if (!MAC_IsRunning())
+    {
+        return;
+    }
+    if (keybrick.isConnected())
+    {
+        uint8_t free = keybrick.txQueueFree();
+        budget = free > MAC_TX_RESERVE ? free - MAC_TX_RESERVE : 0;
+        keybrick.onActivity();
+    }
+    MAC_Update((uint32_t)esp_timer_get_time(), budget);
+}
+
+/**
+ * @brief  文本输入结束后恢复按键状态 (主循环调用)
+ * @note   文本报文由发送任务直接生成，会覆盖主机看到的 Boot 报文；
+ *         输入结束或被中止后作废合成器缓存并重发，主机重新看到当前按住的键
+ */
+void SYS_TextUpdate()
+{
+    if (!textActive)
+    {
+        return;
+    }
+    if (keybrick.isTyping())
+    {
+        keybrick.onActivity();
+        return;
+    }
+    textActive = false;
+    HID_Invalidate();
+    KEY_SendComposed();
+}
+
+/**
+ * @brief  初始化按键动作绑定
+ * @note   事件流水线: KEY_Update -> combo -> tapHold -> SYS_KeyAction
+ *         轻按按当前激活层查找预设键位 (keymap)，
+ *         Key1-Key3 与普通按键一样按下即发送 (TH_EAGER_TAP)，按住 LONG_PRESS_TIME 后额外切换系统模式，
+ *         Key4/Key5 为普通按键 (长按保持主机自动重复)，
+ *         Key1+Key2 同时按下切换主机选择模式，Key4+Key5 同时按下为 Ctrl+Z (撤销)
+ */
+void SYS_KeyActionInit()
+{
+    static const uint8_t undoReport[8] = {0x01, 0x00, 0x1D, 0x00, 0x00, 0x00, 0x00, 0x00}; // Ctrl+Z
+    static const CMB_Combo combos[] = {
+        {0x03, {ACT_MODE, MODE_HOST_SELECT, NULL}}, // Key1 + Key2
+        {0x18, {ACT_REPORT, 0, undoReport}},        // Key4 + Key5
+    };
+    static const uint8_t macroCopyAll[] = {MAC_TAP(0x01, 0x04), MAC_TAP(0x01, 0x06), MAC_END};  // Ctrl+A, Ctrl+C
+    static const uint8_t macroPasteEnter[] = {MAC_TAP(0x01, 0x19), MAC_DELAY(20), MAC_TAP(0x00, 0x28), MAC_END}; // Ctrl+V, Enter
+    static const uint8_t *const macros[] = {macroCopyAll, macroPasteEnter};
+    static const uint8_t holdModes[3] = {MODE_KEY_CONFIG, MODE_TIMER_SET, MODE_METRONOME};
+
+    TH_Init(SYS_KeyAction);
+    for (int i = 0; i < 5; i++)
+    {
+        KeyAction tap = {ACT_KEYMAP, 0, NULL};
+        KeyAction hold = {ACT_NONE, 0, NULL};
+
+        if (i < 3)
+        {
+            hold.type = ACT_MODE;
+            hold.arg = holdModes[i];
+        }
+        TH_SetBinding(i, &tap, &hold, LONG_PRESS_TIME, i < 3 ? TH_EAGER_TAP : 0);
+    }
+
+    MAC_Init(SYS_MacroOutput);
+    MAC_SetTable(macros, sizeof(macros) / sizeof(macros[0]));
+
+    CMB_Init(TH_Process, SYS_KeyAction);
+    CMB_SetCombos(combos, sizeof(combos) / sizeof(combos[0]), CMB_WINDOW_MS);
+    KEY_SetEventCallback(CMB_Process);
+}
+
+/**
+ * @brief  发送未同步的报文
+ * @note   按键动作由 SYS_KeyAction 提交给报文合成器，断开期间的变化在重新连接后由此补发
+ */
+void KEY_Send()
+{
+    KEY_SendComposed();
+}
+
+/**
+ * @brief  释放所有按键
+ * @note   切换模式时调用，中止宏与文本输入、清空合成器并发送空报文 (6KRO 与 NKRO 均清空)，防止卡键
+ */
+void KEY_ReleaseAll()
+{
+    MAC_Stop();
+    keybrick.stopTyping();
+    HID_Reset();
+    HID_Invalidate();
+    KEY_SendComposed();
+}
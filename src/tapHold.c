@@ -0,0 +1,274 @@
+/**
+  ******************************************************************************
+  * @file    tapHold.c
+  * @brief   轻按/按住 (tap-hold) 判定引擎
+  * @note    绑定了按住动作的键按下后进入待判定状态，由后续事件决定结果：
+  *          - 判定时间内释放：轻按
+  *          - 扫描中断上报保持事件 (KEY_EVT_HOLD，按下经过判定时间)：按住
+  *          - 宽松模式下，判定期间另一个键完成按下+释放：按住
+  *          判定期间其他键的事件按顺序缓存，判定完成后再重放，输出顺序与按键顺序一致。
+  *          TH_EAGER_TAP 绑定不进入待判定状态：按下即输出轻按动作，保持事件到达时再叠加按住动作。
+  *          所有判定都由中断带时间戳的事件驱动，不轮询 millis()，延迟上限为判定时间 + 扫描周期
+  ******************************************************************************
+  */
+
+#include "tapHold.h"
+
+#define TH_NONE 0xFF // 无待判定按键
+
+// 按键当前生效的动作
+enum {
+    TH_ACT_IDLE = 0,
+    TH_ACT_TAP,
+    TH_ACT_HOLD,
+    TH_ACT_EAGER,      // TH_EAGER_TAP：轻按动作已输出，按住动作未触发
+    TH_ACT_EAGER_HOLD  // TH_EAGER_TAP：轻按与按住动作均已输出
+};
+
+static TH_Binding thBinding[TH_KEY_COUNT];
+static TH_ActionSink thSink = NULL;
+
+// 以下集合均为位掩码：bit i 对应 Key i+1
+static uint8_t thActive[TH_KEY_COUNT];   // 各键生效的动作 (TH_ACT_*)
+static uint8_t thHeld = 0;               // 动作已生效、尚未释放的键
+static uint8_t thInterrupted = 0;        // 生效期间按下过其他键 (不再补发轻按)
+
+// 待判定状态 (同一时刻最多一个)
+static uint8_t thPending = TH_NONE;
+static uint32_t thPendingTime = 0;       // 待判定键按下的时间戳 (us)
+static uint8_t thPendingPressed = 0;     // 判定期间按下的其他键
+static KeyEvent thBuf[TH_BUFFER_LEN];    // 判定期间缓存的事件
+static uint8_t thBufLen = 0;
+
+static TH_Stats thStats = {0, 0, 0, 0, 0, 0, 0};
+
+/**
+  * @brief  输出动作 (ACT_NONE 不输出)
+  */
+static void TH_Emit(uint8_t key, const KeyAction *act, bool down) {
+    if (act->type != ACT_NONE && thSink) {
+        thSink(key, act, down);
+    }
+}
+
+/**
+  * @brief  判定待判定按键，输出对应动作并重放缓存的事件
+  * @param  act  TH_ACT_TAP 或 TH_ACT_HOLD
+  * @param  time 触发判定的事件时间戳 (us)
+  * @retval None
+  */
+static void TH_Resolve(uint8_t act, uint32_t time) {
+    uint8_t key = thPending;
+    uint8_t n = thBufLen;
+    uint32_t latency = time - thPendingTime;
+    KeyEvent buf[TH_BUFFER_LEN];
+
+    // 重放时可能产生新的待判定键，先取出缓存并清空状态
+    memcpy(buf, thBuf, n * sizeof(KeyEvent));
+    thPending = TH_NONE;
+    thPendingPressed = 0;
+    thBufLen = 0;
+
+    if (latency > thStats.maxResolveUs) {
+        thStats.maxResolveUs = latency;
+    }
+
+    thActive[key] = act;
+    thHeld |= (1 << key);
+    if (act == TH_ACT_HOLD) {
+        thStats.holds++;
+        TH_Emit(key, &thBinding[key].hold, true);
+    } else {
+        thStats.taps++;
+        TH_Emit(key, &thBinding[key].tap, true);
+    }
+
+    for (uint8_t i = 0; i < n; i++) {
+        TH_Process(&buf[i]);
+    }
+}
+
+/**
+  * @brief  处理不需要等待判定的事件
+  * @param  evt 按键事件
+  * @retval None
+  */
+static void TH_Handle(const KeyEvent *evt) {
+    uint8_t key = evt->key;
+    uint8_t bit = 1 << key;
+    const TH_Binding *b = &thBinding[key];
+
+    switch (evt->type) {
+    case KEY_EVT_PRESS:
+        thInterrupted |= thHeld;
+        if (b->hold.type != ACT_NONE && (b->flags & TH_EAGER_TAP)) {
+            thActive[key] = TH_ACT_EAGER;
+            thHeld |= bit;
+            TH_Emit(key, &b->tap, true);
+        } else if (b->hold.type != ACT_NONE) {
+            thPending = key;
+            thPendingTime = evt->time;
+            thPendingPressed = 0;
+            thInterrupted &= ~bit;
+        } else {
+            thActive[key] = TH_ACT_TAP;
+            thHeld |= bit;
+            TH_Emit(key, &b->tap, true);
+        }
+        break;
+
+    case KEY_EVT_RELEASE:
+        if (thActive[key] == TH_ACT_HOLD) {
+            TH_Emit(key, &b->hold, false);
+            if ((b->flags & TH_RETRO_TAP) && !(thInterrupted & bit)) {
+                thStats.retroTaps++;
+                TH_Emit(key, &b->tap, true);
+                TH_Emit(key, &b->tap, false);
+            }
+        } else if (thActive[key] == TH_ACT_TAP) {
+            TH_Emit(key, &b->tap, false);
+        } else if (thActive[key] == TH_ACT_EAGER) {
+            thStats.taps++;
+            TH_Emit(key, &b->tap, false);
+        } else if (thActive[key] == TH_ACT_EAGER_HOLD) {
+            TH_Emit(key, &b->tap, false);
+            TH_Emit(key, &b->hold, false);
+        }
+        thActive[key] = TH_ACT_IDLE;
+        thHeld &= ~bit;
+        thInterrupted &= ~bit;
+        break;
+
+    case KEY_EVT_HOLD:
+        if (thActive[key] == TH_ACT_EAGER) {
+            thActive[key] = TH_ACT_EAGER_HOLD;
+            thStats.holds++;
+            TH_Emit(key, &b->hold, true);
+        }
+        break; // 其他已判定按键的保持事件无需处理
+
+    default:
+        break;
+    }
+}
+
+/**
+  * @brief  缓存判定期间的事件，缓存已满时提前判定为按住并直接处理该事件
+  * @retval bool 是否已缓存
+  */
+static bool TH_Buffer(const KeyEvent *evt) {
+    if (thBufLen >= TH_BUFFER_LEN) {
+        thStats.overflow++;
+        TH_Resolve(TH_ACT_HOLD, evt->time);
+        TH_Process(evt);
+        return false;
+    }
+    thBuf[thBufLen++] = *evt;
+    thStats.buffered++;
+    return true;
+}
+
+/**
+  * @brief  初始化引擎
+  * @param  sink 动作输出回调
+  * @retval None
+  */
+void TH_Init(TH_ActionSink sink) {
+    thSink = sink;
+    thPending = TH_NONE;
+    thPendingPressed = 0;
+    thBufLen = 0;
+    thHeld = 0;
+    thInterrupted = 0;
+    for (int i = 0; i < TH_KEY_COUNT; i++) {
+        thActive[i] = TH_ACT_IDLE;
+    }
+}
+
+/**
+  * @brief  设置按键绑定
+  * @note   判定时间通过 KEY_SetHoldTime 交给扫描中断，到期时由中断上报保持事件
+  * @param  key    按键索引 (0-4)
+  * @param  tap    轻按动作
+  * @param  hold   按住动作，NULL 表示普通按键
+  * @param  termMs 判定时间 (ms)，0 表示使用 TH_TAPPING_TERM_MS
+  * @param  flags  TH_PERMISSIVE_HOLD / TH_RETRO_TAP
+  * @retval None
+  */
+void TH_SetBinding(uint8_t key, const KeyAction *tap, const KeyAction *hold, uint16_t termMs, uint8_t flags) {
+    TH_Binding *b;
+
+    if (key >= TH_KEY_COUNT) {
+        return;
+    }
+    b = &thBinding[key];
+
+    b->tap = *tap;
+    if (hold) {
+        b->hold = *hold;
+    } else {
+        b->hold.type = ACT_NONE;
+        b->hold.arg = 0;
+        b->hold.report = NULL;
+    }
+    b->termMs = termMs ? termMs : TH_TAPPING_TERM_MS;
+    b->flags = flags;
+
+    KEY_SetHoldTime(key, b->hold.type != ACT_NONE ? b->termMs : 0);
+}
+
+/**
+  * @brief  处理一个按键事件
+  * @note   有待判定按键时：
+  *         - 待判定键自身的保持/释放事件完成判定
+  *         - 判定期间按下的键，其事件全部缓存 (宽松模式下其释放触发按住判定)
+  *         - 判定前已生效的键不受影响，直接处理
+  * @param  evt 按下/释放/保持事件
+  * @retval None
+  */
+void TH_Process(const KeyEvent *evt) {
+    uint8_t bit;
+
+    if (evt->key >= TH_KEY_COUNT || evt->type > KEY_EVT_HOLD) {
+        return;
+    }
+
+    if (thPending == TH_NONE) {
+        TH_Handle(evt);
+        return;
+    }
+
+    if (evt->key == thPending) {
+        if (evt->type == KEY_EVT_HOLD) {
+            TH_Resolve(TH_ACT_HOLD, evt->time);
+        } else if (evt->type == KEY_EVT_RELEASE) {
+            TH_Resolve(TH_ACT_TAP, evt->time);
+            TH_Handle(evt);
+        }
+        return;
+    }
+
+    bit = 1 << evt->key;
+    if (evt->type == KEY_EVT_PRESS) {
+        thPendingPressed |= bit;
+        TH_Buffer(evt);
+    } else if (!(thPendingPressed & bit)) {
+        TH_Handle(evt);
+    } else if (evt->type == KEY_EVT_RELEASE && (thBinding[thPending].flags & TH_PERMISSIVE_HOLD)) {
+        if (TH_Buffer(evt)) {
+            thStats.permissiveHolds++;
+            TH_Resolve(TH_ACT_HOLD, evt->time);
+        }
+    } else {
+        TH_Buffer(evt);
+    }
+}
+
+/**
+  * @brief  获取引擎统计
+  * @param  stats 输出统计
+  * @retval None
+  */
+void TH_GetStats(TH_Stats *stats) {
+    *stats = thStats;
+}
@@ -3,14 +3,221 @@
 // 静态成员变量定义
 uint32_t UIManager::lastActivityTime = 0;
 bool UIManager::screenOn = true;
-uint8_t UIManager::scrollPos = 0;
+SystemMode UIManager::shownMode = MODE_NORMAL;
+uint32_t UIManager::lastFrameTime = 0;
+
+// 普通模式内容变化慢 (连接状态/电量/2 秒轮播)，设置类界面需要及时响应按键
+UIManager::FrameConfig UIManager::frameConfig[MODE_COUNT] = {
+    {2, 2000},  // MODE_NORMAL
+    {10, 2000}, // MODE_TIMER_SET
+    {10, 2000}, // MODE_METRONOME
+    {10, 2000}, // MODE_KEY_CONFIG
+    {5, 2000}   // MODE_HOST_SELECT
+};
+volatile bool UIManager::frameInFlight = false;
+
+// =================================================================================
+// 模型绑定 (控件只在这些值变化时重绘)
+// =================================================================================
+
+static int32_t bindBleConnected() { return sysStatus.bleConnected; }
+static int32_t bindBattery() { return BAT_GetPercentage(); }
+static int32_t bindPreset() { return currentPreset; }
+static int32_t bindTimerSetting() { return timer.hours * 60 + timer.minutes; }
+static int32_t bindMetronome() { return (metro.bpm << 8) | metro.timeSig; }
+static int32_t bindMetronomeRunning() { return metro.isRunning; }
+
+// 主机选择：光标槽位 + 该槽位统计 (连接次数/重连耗时变化时重绘)
+static int32_t bindHostSlot()
+{
+    Hid2BleHostSlot slot;
+    keybrick.getHostSlot(hostSlotSel, &slot);
+    return hostSlotSel | (slot.valid << 2) | ((slot.connects & 0xFF) << 3) | ((slot.lastReconnectMs & 0xFFFF) << 11);
+}
+static int32_t bindHostActive() { return (keybrick.getActiveHostSlot() << 1) | sysStatus.bleConnected; }
+
+// 定时器剩余时间 (分钟)，未启用时为 -1
+static int32_t bindTimerRemaining()
+{
+    if (!timer.enabled)
+    {
+        return -1;
+    }
+    return (timer.targetSec - millis()) / 60000;
+}
+
+// =================================================================================
+// 文本格式化
+// =================================================================================
+
+static void fmtConnection(char *buf, size_t size, int32_t connected)
+{
+    snprintf(buf, size, connected ? "Connected" : "Unconnected");
+}
+
+static void fmtTimerRemaining(char *buf, size_t size, int32_t minutes)
+{
+    if (minutes >= 0)
+    {
+        snprintf(buf, size, "TIM remaining: %02d:%02d", (int)(minutes / 60), (int)(minutes % 60));
+    }
+}
+
+static void fmtTimerRunning(char *buf, size_t size, int32_t minutes)
+{
+    if (minutes >= 0)
+    {
+        snprintf(buf, size, "%02d:%02d[ON]", (int)(minutes / 60), (int)(minutes % 60));
+    }
+}
+
+static void fmtTimerSetting(char *buf, size_t size, int32_t minutes)
+{
+    snprintf(buf, size, " <%02d:%02d>", (int)(minutes / 60), (int)(minutes % 60));
+}
+
+static void fmtMetronome(char *buf, size_t size, int32_t value)
+{
+    snprintf(buf, size, "BPM:%03d SIG:%d/4", (int)(value >> 8), (int)(value & 0xFF));
+}
+
+static void fmtMetronomeRunning(char *buf, size_t size, int32_t running)
+{
+    snprintf(buf, size, running ? "[RUN]" : "[OFF]");
+}
+
+static void fmtPresetName(char *buf, size_t size, int32_t preset)
+{
+    snprintf(buf, size, "%s", (const char *)presets[preset].name);
+}
+
+static void fmtPresetIndex(char *buf, size_t size, int32_t preset)
+{
+    snprintf(buf, size, "[%d/%d]", (int)(preset + 1), PRESET_COUNT);
+}
+
+static void fmtKeyDesc(char *buf, size_t size, uint8_t index)
+{
+    snprintf(buf, size, "Key%d: %s", index + 1, presets[currentPreset].keyDescription[index]);
+}
+
+static void fmtKeyDescList(char *buf, size_t size, uint8_t index)
+{
+    snprintf(buf, size, "- Key%d: %s", index + 1, presets[currentPreset].keyDescription[index]);
+}
+
+static void fmtHostIndex(char *buf, size_t size, int32_t value)
+{
+    snprintf(buf, size, "[%d/%d]", (int)(value & 0x03) + 1, HID2BLE_HOST_SLOTS);
+}
+
+static void fmtHostAddr(char *buf, size_t size, int32_t value)
+{
+    Hid2BleHostSlot slot;
+    keybrick.getHostSlot(value & 0x03, &slot);
+    if (slot.valid)
+    {
+        snprintf(buf, size, " Host%d %02X:%02X:%02X", (int)(value & 0x03) + 1, slot.addr[3], slot.addr[4], slot.addr[5]);
+    }
+    else
+    {
+        snprintf(buf, size, " Host%d <empty>", (int)(value & 0x03) + 1);
+    }
+}
+
+static void fmtHostStats(char *buf, size_t size, int32_t value)
+{
+    Hid2BleHostSlot slot;
+    keybrick.getHostSlot(value & 0x03, &slot);
+    snprintf(buf, size, " Con:%lu Rc:%lums", (unsigned long)slot.connects, (unsigned long)slot.lastReconnectMs);
+}
+
+static void fmtHostActive(char *buf, size_t size, int32_t value)
+{
+    snprintf(buf, size, "H%d%s", (int)(value >> 1) + 1, (value & 1) ? "*" : "");
+}
+
+// =================================================================================
+// 界面定义
+// =================================================================================
+
+// 普通模式：标题、蓝牙状态、电量、按键描述轮播 (每 2 秒一项)、定时器剩余时间
+static UIIcon normalTitle(0, 0, 128, 1, (const uint8_t *)Title);
+static UIIcon normalBtIcon(2, 1, 8, 1, BT);
+static UILabel normalConn(10, 1, 66, bindBleConnected, fmtConnection);
+static UIIcon normalBatIcon(90, 1, 8, 1, Bat);
+static UIProgress normalBatLevel(91, 1, 6, bindBattery, 0x3C, 0x24); // 电池图标内的电量条
+static UIValue normalBatValue(100, 1, 3, bindBattery);
+static UILabel normalBatUnit(118, 1, 6, "%");
+static UIMarquee normalKeyDesc(0, 2, 128, 1, 5, 5, 2000, bindPreset, fmtKeyDesc);
+static UILabel normalTimer(0, 3, 128, bindTimerRemaining, fmtTimerRemaining);
+
+static UIWidget *const normalWidgets[] = {
+    &normalTitle, &normalBtIcon, &normalConn, &normalBatIcon, &normalBatLevel,
+    &normalBatValue, &normalBatUnit, &normalKeyDesc, &normalTimer};
+
+// 定时器设置
+static UILabel timerTitle(0, 0, 128, "> Timer Settings");
+static UILabel timerSetting(0, 1, 72, bindTimerSetting, fmtTimerSetting, 16);
+static UILabel timerRunning(72, 1, 56, bindTimerRemaining, fmtTimerRunning);
+static UILabel timerCntDown(72, 2, 56, "Cnt Down");
+static UILabel timerHint(0, 3, 128, "1|HH 2|MM 3|En 4|Rst"); // 操作指引
+
+static UIWidget *const timerWidgets[] = {
+    &timerTitle, &timerSetting, &timerRunning, &timerCntDown, &timerHint};
+
+// 节拍器
+static UILabel metroTitle(0, 0, 128, "> Metronome");
+static UILabel metroInfo(0, 1, 128, bindMetronome, fmtMetronome, 16);
+static UILabel metroHint(0, 3, 96, "1|- 2|+ 3|Sig 4|");
+static UILabel metroState(96, 3, 32, bindMetronomeRunning, fmtMetronomeRunning);
+
+static UIWidget *const metroWidgets[] = {
+    &metroTitle, &metroInfo, &metroHint, &metroState};
+
+// 预设配置：名称、页码、按键映射列表 (两行滚动)
+static UILabel configTitle(0, 0, 96, "> Config Mode");
+static UILabel configIndex(96, 0, 32, bindPreset, fmtPresetIndex);
+static UILabel configTag(0, 1, 36, " Tag:");
+static UILabel configName(36, 1, 92, bindPreset, fmtPresetName);
+static UIMarquee configKeyList(0, 2, 128, 2, 4, 5, 2000, bindPreset, fmtKeyDescList);
+
+static UIWidget *const configWidgets[] = {
+    &configTitle, &configIndex, &configTag, &configName, &configKeyList};
+
+// 主机选择：槽位地址、链路统计 (连接次数/最近重连耗时)，右上角为当前槽位 (* 表示已连接)
+static UILabel hostTitle(0, 0, 64, "> Hosts");
+static UILabel hostIndex(64, 0, 32, bindHostSlot, fmtHostIndex);
+static UILabel hostActive(96, 0, 32, bindHostActive, fmtHostActive);
+static UILabel hostAddr(0, 1, 128, bindHostSlot, fmtHostAddr);
+static UILabel hostStats(0, 2, 128, bindHostSlot, fmtHostStats);
+static UILabel hostHint(0, 3, 128, "2|< 5|> 1|OK 3|Clr");
+
+static UIWidget *const hostWidgets[] = {
+    &hostTitle, &hostIndex, &hostActive, &hostAddr, &hostStats, &hostHint};
+
+static UIScreen normalScreen(normalWidgets, sizeof(normalWidgets) / sizeof(normalWidgets[0]));
+static UIScreen timerScreen(timerWidgets, sizeof(timerWidgets) / sizeof(timerWidgets[0]));
+static UIScreen metroScreen(metroWidgets, sizeof(metroWidgets) / sizeof(metroWidgets[0]));
+static UIScreen configScreen(configWidgets, sizeof(configWidgets) / sizeof(configWidgets[0]));
+static UIScreen hostScreen(hostWidgets, sizeof(hostWidgets) / sizeof(hostWidgets[0]));
+
+// 按 SystemMode 顺序排列
+static UIScreen *const screens[] = {&normalScreen, &timerScreen, &metroScreen, &configScreen, &hostScreen};
 
 void UIManager::begin()
 {
-    OLED_Init(7, 6, 32, 0);
+    OLED_Init(7, 6, 32, 0, IIC_BACKEND_HW);
+    OLED_SetFlushCallback(onFrameDone);
     lastActivityTime = millis();
 }
 
+void UIManager::onFrameDone()
+{
+    // 在 OLED 刷新任务中调用：上一帧已全部写到屏幕
+    frameInFlight = false;
+}
+
 void UIManager::onActivity()
 {
     // 如果有活动 (按键操作)，重置计时器并唤醒屏幕
@@ -38,7 +245,8 @@ void UIManager::setLowBattery(bool isLow)
 
 void UIManager::resetScroll()
 {
-    scrollPos = 0;
+    normalKeyDesc.reset();
+    configKeyList.reset();
 }
 
 bool UIManager::isScreenOn()
@@ -46,6 +254,22 @@ bool UIManager::isScreenOn()
     return screenOn;
 }
 
+/**
+ * @brief  设置某个模式的刷新帧率与单帧时间预算
+ * @param  mode 系统模式
+ * @param  fps 目标帧率 (1-50)
+ * @param  budgetUs 单帧渲染时间预算 (us)，超出部分顺延到下一帧
+ */
+void UIManager::setFrameRate(SystemMode mode, uint8_t fps, uint16_t budgetUs)
+{
+    if (fps == 0)
+    {
+        fps = 1;
+    }
+    frameConfig[mode].fps = fps;
+    frameConfig[mode].budgetUs = budgetUs;
+}
+
 void UIManager::checkTimeout()
 {
     static uint32_t lastCheck = 0;
@@ -73,152 +297,47 @@ void UIManager::update()
     if (!screenOn)
     {
         return;
-    } // 屏幕关闭时不执行渲染，节省 I2C 总线资源
+    } // 屏幕关闭时不执行渲染，显存中的改动留到亮屏后再刷新
 
     checkTimeout();
 
-    switch (currentMode)
+    // 切换界面：清屏并让新界面的所有控件重绘，且不等待帧间隔
+    bool immediate = false;
+    if (currentMode != shownMode)
     {
-    case MODE_NORMAL:
-        drawStatusBar();
-        drawKeyDesc();
-        break;
-
-    case MODE_TIMER_SET:
-        // 渲染定时器设置界面
-        OLED_PrintText(0, 0, "> Timer Settings", 8);
-        char timeStr[16];
-        sprintf(timeStr, " <%02d:%02d>", timer.hours, timer.minutes);
-        OLED_PrintText(0, 1, timeStr, 16);
-
-        // 显示当前运行状态
-        if (timer.enabled)
-        {
-            char timeEn[10];
-            uint32_t remainingSec = (timer.targetSec - millis()) / 1000;
-            sprintf(timeEn, "%02d:%02d[ON]", remainingSec / 3600, (remainingSec % 3600) / 60);
-            OLED_PrintText(72, 1, timeEn, 8);
-        }
-        else
-        {
-            OLED_ClearPart(72, 1, 128, 2);
-        }
-        OLED_PrintText(72, 2, "Cnt Down", 8);
-        OLED_PrintText(0, 3, "1|HH 2|MM 3|En 4|Rst", 8); // 操作指引
-        
-        timerDisplay(); // 此时其实不需要额外显示 timerDisplay，因为上面已经涵盖了逻辑，
-                        // 但原代码逻辑似乎是 MIX 的，这里保持原样，或者根据原意调整。
-                        // 原代码 TIMER_Display 只在 Normal 模式叠加显示。
-                        // 这里 MODE_TIMER_SET 实际上是全屏显示设置。
-        break;
-
-    case MODE_METRONOME:
-        // 渲染节拍器界面
-        OLED_PrintText(0, 0, "> Metronome", 8);
-        char infoStr[32];
-        sprintf(infoStr, "BPM:%03d SIG:%d/4", metro.bpm, metro.timeSig);
-        OLED_PrintText(0, 1, infoStr, 16);
-        OLED_PrintText(0, 3, "1|- 2|+ 3|Sig 4|", 8);
-        OLED_PrintText(96, 3, metro.isRunning ? "[RUN]" : "[OFF]", 8);
-        break;
-
-    case MODE_KEY_CONFIG:
-        // 渲染配置选择界面 (支持滚动列表)
-        static uint32_t lastScroll_cfg = 0;
-
-        OLED_PrintText(0, 0, "> Config Mode", 8);
-        if (changeName)
-        {
-            OLED_ClearPart(30, 1, 128, 2);
-            changeName = false;
-        }
-        // 显示当前预设名称
-        OLED_PrintText(0, 1, " Tag:", 8);
-        OLED_PrintText(36, 1, (const char *)presets[currentPreset].name, 8);
-
-        // 列表显示按键映射详情
-        for (int i = 0; i < 2; i++)
-        {
-            if (scrollPos + i < 5)
-            {
-                char line[24];
-                sprintf(line, "- Key%d: %s", (scrollPos + i + 1), presets[currentPreset].keyDescription[scrollPos + i]);
-                OLED_PrintText(0, 2 + i, line, 8);
-            }
-        }
-        // 列表自动滚动逻辑
-        if (millis() - lastScroll_cfg > 2000)
-        {
-            scrollPos = (scrollPos + 1) % 4;
-            lastScroll_cfg = millis();
-            OLED_ClearPart(12, 2, 128, 4);
-        }
-
-        // 右上角页码
-        char presetInfo[8];
-        sprintf(presetInfo, "[%d/%d]", currentPreset + 1, PRESET_COUNT);
-        OLED_PrintText(96, 0, presetInfo, 8);
-        break;
-    }
-    
-    // 原代码 TIMER_Display 是独立调用的，且只在 NORMAL 模式下显示（虽然 switch 外貌似没有判断）
-    // 仔细看 main.cpp:211 行，TIMER_Display() 是在 case MODE_NORMAL: 里面调用的。
-    // 所以在 update() 里，我们在 case MODE_NORMAL 调用即可。
-    if (currentMode == MODE_NORMAL) {
-        timerDisplay();
+        OLED_Clear();
+        resetScroll();
+        screens[currentMode]->invalidate();
+        shownMode = currentMode;
+        immediate = true;
     }
-}
 
-void UIManager::drawStatusBar()
-{
-    // 顶部状态栏：标题、蓝牙图标、电量
-    OLED_PrintImage(0, 0, 128, 1, (uint8_t *)Title);
-    OLED_PrintImage(2, 1, 8, 1, (uint8_t *)BT);
-    if (sysStatus.bleConnected)
-    {
-        OLED_PrintText(10, 1, "Connected  ", 8);
-    }
-    else
+    // 配置模式下切换了预设，整屏内容都依赖预设
+    if (changeName)
     {
-        OLED_PrintText(10, 1, "Unconnected", 8);
+        screens[MODE_KEY_CONFIG]->invalidate();
+        changeName = false;
+        immediate = true;
     }
 
-    // 电量显示 (右对齐)
-    OLED_PrintImage(90, 1, 15, 1, (uint8_t *)Bat);
-    OLED_PrintVar(100, 1, BAT_GetPercentage(), "int", 3);
-    OLED_PrintText(118, 1, "%", 8);
-}
-
-void UIManager::drawKeyDesc()
-{
-    // 底部滚动显示按键描述 (Carousel Effect)
-    // 由于屏幕较小，采用每 2 秒轮播一个按键功能描述的方式
-    static uint32_t lastScroll = 0;
-    if (scrollPos < 5)
-    {
-        char keydesc[24];
-        sprintf(keydesc, "Key%d: %s", scrollPos + 1, presets[currentPreset].keyDescription[scrollPos]);
-        OLED_PrintText(0, 2, keydesc, 8);
-    }
-    if (millis() - lastScroll > 2000)
+    // 帧调度：按当前模式的目标帧率渲染，与 loop() 的运行速度无关
+    const FrameConfig &cfg = frameConfig[currentMode];
+    if (immediate || millis() - lastFrameTime >= 1000 / cfg.fps)
     {
-        scrollPos = (scrollPos + 1) % 5; // 循环索引 0-4
-        lastScroll = millis();
-        OLED_ClearPart(18, 2, 128, 4); // 局部清除区域
+        lastFrameTime = millis();
+        // 只有绑定值变化的控件会修改显存；超出时间预算的控件顺延到下一帧
+        screens[currentMode]->refresh(cfg.budgetUs);
     }
-}
 
-void UIManager::timerDisplay()
-{
-    if (timer.enabled)
+    // 以上绘制只修改显存，这里把变化的区域交给后台任务刷到屏幕；
+    // 上一帧尚未发送完时不等待，改动留到下一次 update() 再提交 (不受帧间隔限制)
+    // (先置位再提交，避免完成回调先于置位执行)
+    if (!frameInFlight)
     {
-        char timeStr[32];
-        uint32_t remainingSec = (timer.targetSec - millis()) / 1000;
-        sprintf(timeStr, "TIM remaining: %02d:%02d", remainingSec / 3600, (remainingSec % 3600) / 60);
-        OLED_PrintText(0, 3, timeStr, 8);
-    }
-    else
-    {
-        OLED_ClearPart(0, 3, 128, 4);
+        frameInFlight = true;
+        if (!OLED_Flush())
+        {
+            frameInFlight = false; // 没有需要发送的内容
+        }
     }
 }
@@ -0,0 +1,207 @@
+#include "ui_widget.h"
+
+// =================================================================================
+// UIWidget
+// =================================================================================
+
+UIWidget::UIWidget(uint8_t x, uint8_t y, uint8_t width, uint8_t height, UIBinding bind)
+    : x(x), y(y), width(width), height(height), bind(bind), lastValue(0), valid(false)
+{
+}
+
+bool UIWidget::refresh()
+{
+    int32_t v = value();
+    if (valid && v == lastValue)
+    {
+        return false; // 绑定值未变化，不重绘
+    }
+    render(v);
+    lastValue = v;
+    valid = true;
+    return true;
+}
+
+void UIWidget::invalidate()
+{
+    valid = false;
+}
+
+int32_t UIWidget::value()
+{
+    return (bind != NULL) ? bind() : 0;
+}
+
+void UIWidget::clearArea()
+{
+    OLED_ClearPart(x, y, x + width, y + height);
+}
+
+// =================================================================================
+// UILabel
+// =================================================================================
+
+UILabel::UILabel(uint8_t x, uint8_t y, uint8_t width, const char *text, uint8_t size)
+    : UIWidget(x, y, width, size / 8, NULL), text(text), format(NULL), size(size)
+{
+}
+
+UILabel::UILabel(uint8_t x, uint8_t y, uint8_t width, UIBinding bind, UIFormatter format, uint8_t size)
+    : UIWidget(x, y, width, size / 8, bind), text(NULL), format(format), size(size)
+{
+}
+
+void UILabel::render(int32_t value)
+{
+    char buf[32];
+    const char *str = text;
+
+    if (format != NULL)
+    {
+        buf[0] = '\0';
+        format(buf, sizeof(buf), value);
+        str = buf;
+    }
+
+    clearArea();
+    if (str[0] != '\0')
+    {
+        OLED_PrintText(x, y, str, size);
+    }
+}
+
+// =================================================================================
+// UIIcon
+// =================================================================================
+
+UIIcon::UIIcon(uint8_t x, uint8_t y, uint8_t width, uint8_t height, const uint8_t *image)
+    : UIWidget(x, y, width, height, NULL), image(image)
+{
+}
+
+void UIIcon::render(int32_t value)
+{
+    OLED_PrintImage(x, y, width, height, (uint8_t *)image);
+}
+
+// =================================================================================
+// UIValue
+// =================================================================================
+
+UIValue::UIValue(uint8_t x, uint8_t y, uint8_t digits, UIBinding bind)
+    : UIWidget(x, y, digits * 6, 1, bind), digits(digits)
+{
+}
+
+void UIValue::render(int32_t value)
+{
+    OLED_PrintVar(x, y, value, "int", digits);
+}
+
+// =================================================================================
+// UIMarquee
+// =================================================================================
+
+UIMarquee::UIMarquee(uint8_t x, uint8_t y, uint8_t width, uint8_t lines, uint8_t count, uint8_t itemCount,
+                     uint32_t period, UIBinding bind, UIItemFormatter format)
+    : UIWidget(x, y, width, lines, bind), lines(lines), count(count), itemCount(itemCount),
+      period(period), format(format), index(0), lastStep(0)
+{
+}
+
+void UIMarquee::reset()
+{
+    index = 0;
+    lastStep = millis();
+}
+
+int32_t UIMarquee::value()
+{
+    if (millis() - lastStep > period)
+    {
+        index = (index + 1) % count;
+        lastStep = millis();
+    }
+    // 高位为绑定值，低 8 位为当前位置，任一变化都会触发重绘
+    return (UIWidget::value() << 8) | index;
+}
+
+void UIMarquee::render(int32_t value)
+{
+    char buf[32];
+
+    clearArea();
+    for (uint8_t i = 0; i < lines; i++)
+    {
+        if (index + i < itemCount)
+        {
+            format(buf, sizeof(buf), index + i);
+            OLED_PrintText(x, y + i, buf, 8);
+        }
+    }
+}
+
+// =================================================================================
+// UIProgress
+// =================================================================================
+
+UIProgress::UIProgress(uint8_t x, uint8_t y, uint8_t width, UIBinding bind, uint8_t fill, uint8_t empty)
+    : UIWidget(x, y, width, 1, bind), fill(fill), empty(empty)
+{
+}
+
+void UIProgress::render(int32_t value)
+{
+    if (value < 0)
+    {
+        value = 0;
+    }
+    else if (value > 100)
+    {
+        value = 100;
+    }
+
+    uint8_t filled = (value * width + 50) / 100;
+    for (uint8_t i = 0; i < width; i++)
+    {
+        OLED_PrintImage(x + i, y, 1, 1, (i < filled) ? &fill : &empty);
+    }
+}
+
+// =================================================================================
+// UIScreen
+// =================================================================================
+
+UIScreen::UIScreen(UIWidget *const *widgets, uint8_t count)
+    : widgets(widgets), count(count), next(0)
+{
+}
+
+bool UIScreen::refresh(uint32_t budgetUs)
+{
+    uint32_t start = micros();
+
+    while (next < count)
+    {
+        widgets[next]->refresh();
+        next++;
+
+        // 预算用完：剩余控件留到下一帧 (至少推进一个控件，保证不会饿死)
+        if (next < count && micros() - start > budgetUs)
+        {
+            return false;
+        }
+    }
+
+    next = 0;
+    return true;
+}
+
+void UIScreen::invalidate()
+{
+    for (uint8_t i = 0; i < count; i++)
+    {
+        widgets[i]->invalidate();
+    }
+    next = 0;
+}
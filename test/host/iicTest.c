@@ -0,0 +1,131 @@
+/*
+软件 IIC 时序测试 (主机端运行，IIC_HAL_MOCK)
+从模拟 HAL 记录的 SDA/SCL 电平序列还原 Start / 字节 / ACK / Stop，与期望的传输比对
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include "iic.h"
+
+#define TEST_SCL 7
+#define TEST_SDA 6
+#define TEST_BUS 0
+
+static int failures;
+
+#define CHECK(cond)                                                   \
+	do {                                                              \
+		if (!(cond)) {                                                \
+			printf("  FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);  \
+			failures++;                                               \
+		}                                                             \
+	} while (0)
+
+// 还原出的总线事件：'S' Start, 'P' Stop, 'B' 字节 (byte + 第 9 个时钟时主机是否释放 SDA)
+typedef struct {
+	char type;
+	uint8_t byte;
+	uint8_t released;
+} BusEvent;
+
+static int decode(BusEvent *ev, int max) {
+	uint32_t scl = 1UL << TEST_SCL, sda = 1UL << TEST_SDA;
+	uint32_t prev = scl | sda; // IIC_Init 后总线空闲
+	uint16_t bits = 0, nbits = 0;
+	int n = 0;
+
+	for (int i = 0; i < IIC_Mock.traceLen && n < max; i++) {
+		uint32_t cur = IIC_Mock.trace[i];
+
+		// SCL 高电平期间 SDA 只能在 Start/Stop 时变化
+		if ((prev & scl) && (cur & scl) && ((prev ^ cur) & sda)) {
+			ev[n].type = (cur & sda) ? 'P' : 'S';
+			// Stop 前拉高 SCL 的那个时钟不属于任何字节
+			CHECK(nbits == (ev[n].type == 'P' ? 1 : 0));
+			n++;
+			bits = nbits = 0;
+		} else if (!(prev & scl) && (cur & scl)) {
+			bits = (bits << 1) | ((cur & sda) ? 1 : 0);
+			if (++nbits == 9) {
+				ev[n].type = 'B';
+				ev[n].byte = bits >> 1;
+				ev[n].released = bits & 1;
+				n++;
+				bits = nbits = 0;
+			}
+		}
+		prev = cur;
+	}
+	return n;
+}
+
+static void resetTrace(void) {
+	IIC_Mock.traceLen = 0;
+	IIC_Mock.delayUs = 0;
+}
+
+static void testInit(void) {
+	printf("init\n");
+	memset(&IIC_Mock, 0, sizeof(IIC_Mock));
+	IIC_Init(TEST_SCL, TEST_SDA, 0, TEST_BUS);
+
+	CHECK(IIC_Mock.pinMode[TEST_SCL] == OUTPUT);
+	CHECK(IIC_Mock.pinMode[TEST_SDA] == OUTPUT);
+	CHECK(IIC_Mock.out == ((1UL << TEST_SCL) | (1UL << TEST_SDA)));
+}
+
+static void testWriteBurst(void) {
+	static const uint8_t data[] = {0xA5, 0x3C, 0x00, 0xFF};
+	const uint8_t expect[] = {0x78, 0x40, 0xA5, 0x3C, 0x00, 0xFF};
+	BusEvent ev[16] = {{0}};
+	int n;
+
+	printf("start / bytes / ack / stop\n");
+	resetTrace();
+	IIC_Mock.in = 0; // 从机应答 (SDA 拉低)
+	IIC_WriteBurst(TEST_BUS, 0x78, 0x40, data, sizeof(data));
+
+	n = decode(ev, 16);
+	CHECK(n == 2 + (int)sizeof(expect));
+	CHECK(ev[0].type == 'S');
+	for (int i = 0; i < (int)sizeof(expect) && i + 1 < n; i++) {
+		CHECK(ev[i + 1].type == 'B');
+		CHECK(ev[i + 1].byte == expect[i]);
+		CHECK(ev[i + 1].released == 1); // ACK 时钟主机释放 SDA，由从机拉低
+	}
+	CHECK(n > 0 && ev[n - 1].type == 'P');
+	CHECK(IIC_Mock.out == ((1UL << TEST_SCL) | (1UL << TEST_SDA))); // Stop 后总线空闲
+	CHECK(IIC_Mock.delayUs == 0);
+}
+
+static void testAck(void) {
+	printf("ack / nack\n");
+	IIC_Mock.in = 0;
+	CHECK(IIC_RcvACK(TEST_BUS) == 0);
+	IIC_Mock.in = 1UL << TEST_SDA;
+	CHECK(IIC_RcvACK(TEST_BUS) == 1);
+	IIC_Mock.in = 0xFFFFFFFFUL;
+	CHECK(IIC_ReadByte(TEST_BUS) == 0xFF);
+	IIC_Mock.in = 0;
+	CHECK(IIC_ReadByte(TEST_BUS) == 0x00);
+}
+
+static void testDelay(void) {
+	printf("bus delay\n");
+	IIC_Init(TEST_SCL, TEST_SDA, 2, TEST_BUS);
+	resetTrace();
+	IIC_Start(TEST_BUS);
+	IIC_Stop(TEST_BUS);
+	// Start 4 次 + Stop 3 次电平操作，每次之后延时 spd
+	CHECK(IIC_Mock.delayUs == 7 * 2);
+}
+
+int main(void) {
+	testInit();
+	testWriteBurst();
+	testAck();
+	testDelay();
+
+	printf(failures ? "%d check(s) failed\n" : "all passed\n", failures);
+	return failures ? 1 : 0;
+}
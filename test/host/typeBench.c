@@ -0,0 +1,146 @@
+/*
+typeString 打包速度基准 (主机端运行)
+用虚拟时钟模拟发送任务：hidTyperBegin/hidTyperNext 生成报文，令牌桶按连接间隔限速 (与 Hid2Ble::waitTxToken 相同)，
+模拟的 notify 按主机的方式把报文还原为文本并校验，输出每种 maxKeys 下的字符速度
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include "HidAscii.h"
+
+#define TX_PER_EVENT 4      // 同 HID2BLE_TX_PER_EVENT
+#define TX_INTERVAL_US 7500 // 同 HID2BLE_TX_INTERVAL_US
+#define TICK_US 1000        // vTaskDelay(1)，FreeRTOS 1 kHz 节拍
+
+static const char benchText[] =
+	"The quick brown fox jumps over the lazy dog.\n"
+	"Pack my box with five dozen liquor jugs!\n"
+	"ESP32-C3 BLE HID keyboard: typeString() @ 7.5ms, 4 notify/event.\n"
+	"int main(void) { return printf(\"%d\\n\", 42) > 0 ? 0 : 1; }\n";
+
+static int64_t nowUs;
+
+// 令牌桶 (逻辑同 Hid2Ble::waitTxToken，时间由虚拟时钟推进)
+static uint32_t txTokens;
+static int64_t txLastRefill;
+static uint32_t throttled;
+
+static void waitTxToken(void)
+{
+	for (;;)
+	{
+		uint32_t refill = (nowUs - txLastRefill) / TX_INTERVAL_US;
+
+		if (refill > 0)
+		{
+			uint32_t tokens = txTokens + refill * TX_PER_EVENT;
+			txTokens = tokens > TX_PER_EVENT ? TX_PER_EVENT : tokens;
+			txLastRefill = nowUs;
+		}
+		if (txTokens > 0)
+		{
+			txTokens--;
+			return;
+		}
+		throttled++;
+		nowUs += TICK_US;
+	}
+}
+
+// 模拟主机：新按下的键按数组顺序输入，修饰键取本报文的值
+static uint8_t hostRev[2][128];
+static uint8_t hostLast[HID_TYPER_REPORT_LEN];
+static char hostText[sizeof(benchText)];
+static size_t hostLen;
+
+static void hostInit(void)
+{
+	memset(hostRev, 0, sizeof(hostRev));
+	for (int c = 127; c > 0; c--)
+	{
+		uint8_t mods, usage;
+
+		if (hidAsciiLookup(c, &mods, &usage))
+		{
+			hostRev[mods ? 1 : 0][usage] = c;
+		}
+	}
+	memset(hostLast, 0, sizeof(hostLast));
+	hostLen = 0;
+}
+
+static void mockNotify(const uint8_t *report)
+{
+	for (int i = 2; i < HID_TYPER_REPORT_LEN; i++)
+	{
+		bool held = false;
+
+		if (report[i] == 0)
+		{
+			continue;
+		}
+		for (int k = 2; k < HID_TYPER_REPORT_LEN; k++)
+		{
+			held |= hostLast[k] == report[i];
+		}
+		if (!held && hostLen < sizeof(hostText) - 1)
+		{
+			hostText[hostLen++] = hostRev[(report[0] & HID_ASCII_MOD_SHIFT) ? 1 : 0][report[i] & 0x7F];
+		}
+	}
+	memcpy(hostLast, report, HID_TYPER_REPORT_LEN);
+}
+
+/**
+ * 以 maxKeys 打包输出一遍文本，返回 false 表示主机还原的文本与原文不符
+ */
+static bool runOnce(uint8_t maxKeys)
+{
+	struct HidTyper typer;
+	uint8_t report[HID_TYPER_REPORT_LEN];
+	uint32_t reports = 0;
+	int64_t start = 0;
+	uint32_t elapsed, cps;
+
+	nowUs = 0;
+	txTokens = TX_PER_EVENT;
+	txLastRefill = 0;
+	throttled = 0;
+	hostInit();
+
+	hidTyperBegin(&typer, benchText, maxKeys);
+	while (hidTyperNext(&typer, report))
+	{
+		waitTxToken();
+		if (reports++ == 0)
+		{
+			start = nowUs;
+		}
+		mockNotify(report);
+	}
+	hostText[hostLen] = '\0';
+
+	elapsed = nowUs - start;
+	cps = elapsed ? (uint64_t)typer.chars * 1000000 / elapsed : 0;
+	printf("maxKeys=%u  chars=%u  reports=%u  reports/char=%.2f  throttled=%u  time=%.1fms  %u chars/s\n",
+		   maxKeys, typer.chars, reports, (double)reports / typer.chars, throttled, elapsed / 1000.0, cps);
+
+	if (strcmp(hostText, benchText) != 0 || typer.skipped != 0)
+	{
+		printf("  mismatch: host typed \"%s\"\n", hostText);
+		return false;
+	}
+	return true;
+}
+
+int main(void)
+{
+	bool ok = true;
+
+	printf("typeString benchmark: %u chars, %d notify per %d us\n", (unsigned)strlen(benchText), TX_PER_EVENT, TX_INTERVAL_US);
+	for (uint8_t maxKeys = 1; maxKeys <= 6; maxKeys++)
+	{
+		ok &= runOnce(maxKeys);
+	}
+	return ok ? 0 : 1;
+}